@@ -20,7 +20,11 @@
 #ifndef AVLSET_HPP
 #define AVLSET_HPP
 
+#include <cstddef>
 #include <functional>
+#include <future>
+#include <iterator>
+#include "ParallelBuild.hpp"
 #include "Set.hpp"
 
 
@@ -32,6 +36,57 @@ public:
     // ElementType and returns no value.
     using VisitFunction = std::function<void(const ElementType&)>;
 
+    // containsMany() looks up elements in groups of this many.
+    static constexpr unsigned int LOOKUP_GROUP_SIZE = 16;
+
+private:
+    class TreeNode;
+
+public:
+    // An Iterator visits the elements of an AVLSet in ascending order.  It
+    // moves from one node to the next by following parent pointers, so it
+    // needs no stack, and moving to the next element takes O(1) time on
+    // average.  Adding an element to the set invalidates its iterators.
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = ElementType;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const ElementType*;
+        using reference = const ElementType&;
+
+        Iterator() : node(NULL) { }
+
+        reference operator*() const { return node->element; }
+        pointer operator->() const { return &node->element; }
+
+        Iterator& operator++();
+        Iterator operator++(int);
+
+        bool operator==(const Iterator& other) const { return node == other.node; }
+        bool operator!=(const Iterator& other) const { return node != other.node; }
+
+    private:
+        friend class AVLSet;
+        explicit Iterator(const TreeNode* node) : node(node) { }
+
+        const TreeNode* node;
+    };
+
+    // A Range is a pair of Iterators that can be used in a range-based
+    // for loop.
+    class Range {
+    public:
+        Range(Iterator first, Iterator last) : first(first), last(last) { }
+
+        Iterator begin() const { return first; }
+        Iterator end() const { return last; }
+
+    private:
+        Iterator first;
+        Iterator last;
+    };
+
 public:
     // Initializes an AVLSet to be empty, with or without balancing.
     explicit AVLSet(bool shouldBalance = true);
@@ -64,12 +119,28 @@ public:
     virtual void add(const ElementType& element) override;
 
 
+    // addAll() adds an array of elements to the set, skipping any that are
+    // already in it.  Rather than adding the elements one at a time, it
+    // sorts a copy of them using the given number of threads, merges them
+    // with the elements already in the tree, and then builds a perfectly
+    // balanced tree from the merged elements in linear time.
+    void addAll(const ElementType* elements, unsigned int count, unsigned int threadCount = defaultThreadCount());
+
+
     // contains() returns true if the given element is already in the set,
     // false otherwise.  This function always runs in O(log n) time when
     // there are n elements in the AVL tree.
     virtual bool contains(const ElementType& element) const override;
 
 
+    // containsMany() sets results[i] to contains(elements[i]) for each of
+    // the "count" elements.  It descends for LOOKUP_GROUP_SIZE elements at a
+    // time, moving each one down a level in turn and prefetching the node
+    // it'll visit next, so the cache misses of the whole group overlap
+    // instead of being waited out one after another.
+    void containsMany(const ElementType* elements, unsigned int count, bool* results) const;
+
+
     // size() returns the number of elements in the set.
     virtual unsigned int size() const noexcept override;
 
@@ -97,6 +168,43 @@ public:
     void postorder(VisitFunction visit) const;
 
 
+    // begin() and end() return Iterators to the smallest element and to just
+    // past the largest one.
+    Iterator begin() const;
+    Iterator end() const;
+
+
+    // lowerBound() returns an Iterator to the smallest element that is not
+    // less than the given one, and upperBound() returns an Iterator to the
+    // smallest element that is greater than the given one.  Either returns
+    // end() if there is no such element.  Both run in O(log n) time.
+    Iterator lowerBound(const ElementType& element) const;
+    Iterator upperBound(const ElementType& element) const;
+
+
+    // prefixRange() returns the Range of elements that begin with the given
+    // prefix, in ascending order.  It runs in O(log n) time, plus O(1) on
+    // average for each element iterated.  It's only available when
+    // ElementType is a std::string (or behaves like one).
+    Range prefixRange(const ElementType& prefix) const;
+
+
+    // unionWith(), intersectWith() and differenceWith() replace the contents
+    // of this set with its union, intersection or difference with another
+    // AVLSet, leaving the other set unchanged.  They use join-based
+    // algorithms: this tree is split around the root of the other, the two
+    // halves are combined with the other's subtrees recursively, and the
+    // results are joined back together around the root.  That takes
+    // O(m log(n/m + 1)) time for sets of sizes m <= n, and the two halves
+    // at the top levels of the recursion are combined in parallel, using up
+    // to the given number of threads.  If both trees are balanced, so is
+    // the result; if this set was constructed not to balance itself, the
+    // result isn't rebalanced either.  The other set may be this one.
+    void unionWith(const AVLSet& other, unsigned int threadCount = defaultThreadCount());
+    void intersectWith(const AVLSet& other, unsigned int threadCount = defaultThreadCount());
+    void differenceWith(const AVLSet& other, unsigned int threadCount = defaultThreadCount());
+
+
 private:
     // You'll no doubt want to add member variables and "helper" member
     // functions here.
@@ -108,9 +216,10 @@ private:
         ElementType element;
         TreeNode* leftChild;
         TreeNode* rightChild;
+        TreeNode* parent;
         int height;
 
-        TreeNode(const ElementType& e) : element(e), leftChild(NULL), rightChild(NULL), height(-1) { }
+        TreeNode(const ElementType& e, TreeNode* parent = NULL) : element(e), leftChild(NULL), rightChild(NULL), parent(parent), height(0) { }
 
         ~TreeNode() noexcept {
             delete leftChild;
@@ -119,8 +228,10 @@ private:
 
         TreeNode(const TreeNode* s) {
             this->element = s->element;
+            this->parent = NULL;
             if(s->leftChild != NULL) {
                 this->leftChild = new TreeNode(s->leftChild);
+                this->leftChild->parent = this;
             }
             else {
                 this->leftChild = NULL;
@@ -128,6 +239,7 @@ private:
 
             if(s->rightChild != NULL) {
                 this->rightChild = new TreeNode(s->rightChild);
+                this->rightChild->parent = this;
             }
             else {
                 this->rightChild = NULL;
@@ -140,6 +252,8 @@ private:
 
     void recursiveAdd(const ElementType& element, TreeNode *&root);
 
+    TreeNode* buildBalanced(const ElementType* sortedElements, unsigned int begin, unsigned int end);
+
     bool containsRecursive(const ElementType& element, TreeNode* root) const;
 
     unsigned int recursiveSize(TreeNode* root) const noexcept;
@@ -159,6 +273,25 @@ private:
     void rotateLeftRight(TreeNode *&node);
     void balance(TreeNode *&node);
     int balanceFactor(TreeNode* node);
+
+    // cached heights, which add() and the rotations keep up to date
+    static int nodeHeight(const TreeNode* node) noexcept;
+    static void updateHeight(TreeNode* node) noexcept;
+
+    // join-based set algebra; each of these takes ownership of the subtrees
+    // passed to it and returns the root of the resulting subtree
+    static constexpr int PARALLEL_HEIGHT = 12;
+
+    TreeNode* join(TreeNode* left, TreeNode* middle, TreeNode* right);
+    TreeNode* joinPair(TreeNode* left, TreeNode* right);
+    TreeNode* splitLast(TreeNode* root, TreeNode*& last);
+    void split(TreeNode* root, const ElementType& element, TreeNode*& left, TreeNode*& found, TreeNode*& right);
+
+    TreeNode* unionRecursive(TreeNode* root, const TreeNode* other, unsigned int parallelLevels);
+    TreeNode* intersectRecursive(TreeNode* root, const TreeNode* other, unsigned int parallelLevels);
+    TreeNode* differenceRecursive(TreeNode* root, const TreeNode* other, unsigned int parallelLevels);
+
+    static unsigned int parallelLevelsFor(unsigned int threadCount) noexcept;
 };
 
 
@@ -249,35 +382,164 @@ void AVLSet<ElementType>::add(const ElementType& element)
 
 template <typename ElementType>
 void AVLSet<ElementType>::recursiveAdd(const ElementType& element, TreeNode *&root) {
+    if(root->element == element) {
+        return;
+    }
     if(root->element > element) {
         if(root->leftChild != NULL) {
             recursiveAdd(element, root->leftChild);
+            updateHeight(root);
             if(shouldBalance)
                 balance(root);
         }
         else {
-            root->leftChild = new TreeNode(element);
+            root->leftChild = new TreeNode(element, root);
+            updateHeight(root);
         }
     }
     else {
         if(root->rightChild != NULL) {
             recursiveAdd(element, root->rightChild);
+            updateHeight(root);
             if(shouldBalance)
                 balance(root);
         }
         else {
-            root->rightChild = new TreeNode(element);
+            root->rightChild = new TreeNode(element, root);
+            updateHeight(root);
         }    
     }
 }
 
 
+template <typename ElementType>
+void AVLSet<ElementType>::addAll(const ElementType* elements, unsigned int count, unsigned int threadCount)
+{
+    if(count == 0) {
+        return;
+    }
+
+    ElementType* added = new ElementType[count];
+    for(unsigned int i = 0; i < count; i++) {
+        added[i] = elements[i];
+    }
+    parallelSort(added, count, threadCount);
+
+    unsigned int existingCount = size();
+    ElementType* existing = new ElementType[existingCount == 0 ? 1 : existingCount];
+    unsigned int next = 0;
+    inorder([&](const ElementType& element) { existing[next++] = element; });
+
+    // merge the two sorted arrays, dropping duplicates as we go
+    ElementType* merged = new ElementType[existingCount + count];
+    unsigned int mergedCount = 0;
+    unsigned int i = 0;
+    unsigned int j = 0;
+
+    while(i < existingCount || j < count) {
+        const ElementType* smallest;
+        if(j == count || (i < existingCount && !(added[j] < existing[i]))) {
+            smallest = &existing[i++];
+        }
+        else {
+            smallest = &added[j++];
+        }
+
+        if(mergedCount == 0 || !(merged[mergedCount - 1] == *smallest)) {
+            merged[mergedCount++] = *smallest;
+        }
+    }
+
+    delete[] existing;
+    delete[] added;
+
+    delete avlTree;
+    avlTree = buildBalanced(merged, 0, mergedCount);
+
+    delete[] merged;
+}
+
+template <typename ElementType>
+typename AVLSet<ElementType>::TreeNode* AVLSet<ElementType>::buildBalanced(const ElementType* sortedElements, unsigned int begin, unsigned int end)
+{
+    if(begin == end) {
+        return NULL;
+    }
+
+    unsigned int middle = begin + (end - begin) / 2;
+    TreeNode* node = new TreeNode(sortedElements[middle]);
+    node->leftChild = buildBalanced(sortedElements, begin, middle);
+    node->rightChild = buildBalanced(sortedElements, middle + 1, end);
+
+    if(node->leftChild != NULL) {
+        node->leftChild->parent = node;
+    }
+    if(node->rightChild != NULL) {
+        node->rightChild->parent = node;
+    }
+
+    int leftHeight = node->leftChild == NULL ? -1 : node->leftChild->height;
+    int rightHeight = node->rightChild == NULL ? -1 : node->rightChild->height;
+    node->height = 1 + (leftHeight < rightHeight ? rightHeight : leftHeight);
+
+    return node;
+}
+
+
 template <typename ElementType>
 bool AVLSet<ElementType>::contains(const ElementType& element) const
 {
     return containsRecursive(element, avlTree);
 }
 
+template <typename ElementType>
+void AVLSet<ElementType>::containsMany(const ElementType* elements, unsigned int count, bool* results) const
+{
+    TreeNode* nodes[LOOKUP_GROUP_SIZE];
+
+    for(unsigned int first = 0; first < count; first += LOOKUP_GROUP_SIZE) {
+        unsigned int groupSize = count - first < LOOKUP_GROUP_SIZE ? count - first : LOOKUP_GROUP_SIZE;
+
+        for(unsigned int i = 0; i < groupSize; i++) {
+            nodes[i] = avlTree;
+            results[first + i] = false;
+        }
+
+        // a lookup drops out of the group (its node becomes NULL) when it
+        // finds its element or falls off the tree
+        bool moving = true;
+        while(moving) {
+            moving = false;
+            for(unsigned int i = 0; i < groupSize; i++) {
+                TreeNode* node = nodes[i];
+                if(node == NULL) {
+                    continue;
+                }
+
+                if(node->element == elements[first + i]) {
+                    results[first + i] = true;
+                    node = NULL;
+                }
+                else if(node->element > elements[first + i]) {
+                    node = node->leftChild;
+                }
+                else {
+                    node = node->rightChild;
+                }
+
+#if defined(__GNUC__)
+                if(node != NULL) {
+                    __builtin_prefetch(node);
+                }
+#endif
+                nodes[i] = node;
+                moving = moving || node != NULL;
+            }
+        }
+    }
+}
+
+
 template <typename ElementType>
 bool AVLSet<ElementType>::containsRecursive(const ElementType& element, TreeNode* root) const
 {
@@ -388,13 +650,118 @@ void AVLSet<ElementType>::recursivePostorder(VisitFunction visit, TreeNode* root
     visit(root->element);
 }
 
+template <typename ElementType>
+typename AVLSet<ElementType>::Iterator& AVLSet<ElementType>::Iterator::operator++()
+{
+    if(node->rightChild != NULL) {
+        // the next element is the leftmost one in the right subtree
+        node = node->rightChild;
+        while(node->leftChild != NULL) {
+            node = node->leftChild;
+        }
+    }
+    else {
+        // otherwise, it's the first ancestor we reach from its left side
+        const TreeNode* child = node;
+        node = node->parent;
+        while(node != NULL && node->rightChild == child) {
+            child = node;
+            node = node->parent;
+        }
+    }
+    return *this;
+}
+
+template <typename ElementType>
+typename AVLSet<ElementType>::Iterator AVLSet<ElementType>::Iterator::operator++(int)
+{
+    Iterator previous = *this;
+    ++*this;
+    return previous;
+}
+
+template <typename ElementType>
+typename AVLSet<ElementType>::Iterator AVLSet<ElementType>::begin() const
+{
+    const TreeNode* node = avlTree;
+    while(node != NULL && node->leftChild != NULL) {
+        node = node->leftChild;
+    }
+    return Iterator{node};
+}
+
+template <typename ElementType>
+typename AVLSet<ElementType>::Iterator AVLSet<ElementType>::end() const
+{
+    return Iterator{};
+}
+
+template <typename ElementType>
+typename AVLSet<ElementType>::Iterator AVLSet<ElementType>::lowerBound(const ElementType& element) const
+{
+    const TreeNode* candidate = NULL;
+    const TreeNode* node = avlTree;
+    while(node != NULL) {
+        if(element > node->element) {
+            node = node->rightChild;
+        }
+        else {
+            candidate = node;
+            node = node->leftChild;
+        }
+    }
+    return Iterator{candidate};
+}
+
+template <typename ElementType>
+typename AVLSet<ElementType>::Iterator AVLSet<ElementType>::upperBound(const ElementType& element) const
+{
+    const TreeNode* candidate = NULL;
+    const TreeNode* node = avlTree;
+    while(node != NULL) {
+        if(node->element > element) {
+            candidate = node;
+            node = node->leftChild;
+        }
+        else {
+            node = node->rightChild;
+        }
+    }
+    return Iterator{candidate};
+}
+
+template <typename ElementType>
+typename AVLSet<ElementType>::Range AVLSet<ElementType>::prefixRange(const ElementType& prefix) const
+{
+    // every element with the prefix is less than the prefix with its last
+    // character incremented (once any characters that can't be incremented
+    // are dropped from its end)
+    ElementType limit = prefix;
+    while(!limit.empty() && static_cast<unsigned char>(limit.back()) == 0xFF) {
+        limit.pop_back();
+    }
+
+    if(limit.empty()) {
+        return Range{lowerBound(prefix), end()};
+    }
+
+    limit.back() = static_cast<char>(static_cast<unsigned char>(limit.back()) + 1);
+    return Range{lowerBound(prefix), lowerBound(limit)};
+}
+
 template <typename ElementType>
 void AVLSet<ElementType>::rotateLeft(TreeNode *&node) 
 {
     TreeNode* tmpNode = node->rightChild;
     node->rightChild = tmpNode->leftChild;
+    if(node->rightChild != NULL)
+        node->rightChild->parent = node;
     tmpNode->leftChild = node;
 
+    tmpNode->parent = node->parent;
+    node->parent = tmpNode;
+    updateHeight(node);
+    updateHeight(tmpNode);
     node = tmpNode;
 }
 
@@ -403,8 +770,14 @@ void AVLSet<ElementType>::rotateRight(TreeNode *&node)
 {
     TreeNode* tmpNode = node->leftChild;
     node->leftChild = tmpNode->rightChild;
+    if(node->leftChild != NULL)
+        node->leftChild->parent = node;
     tmpNode->rightChild = node;
 
+    tmpNode->parent = node->parent;
+    node->parent = tmpNode;
+    updateHeight(node);
+    updateHeight(tmpNode);
     node = tmpNode;   
 }
 
@@ -431,13 +804,13 @@ void AVLSet<ElementType>::balance(TreeNode *&node)
 {
     int factor = balanceFactor(node);
     if(factor > 1) {
-        if(balanceFactor(node->leftChild) > 0)
+        if(balanceFactor(node->leftChild) >= 0)
             rotateRight(node);
         else
             rotateLeftRight(node);
     }
     if(factor < -1) {
-        if(balanceFactor(node->rightChild) < 0) 
+        if(balanceFactor(node->rightChild) <= 0) 
             rotateLeft(node);
         else
             rotateRightLeft(node);
@@ -447,15 +820,267 @@ void AVLSet<ElementType>::balance(TreeNode *&node)
 template <typename ElementType>   
 int AVLSet<ElementType>::balanceFactor(TreeNode *node)
 {
-    int leftHeight = recursiveHeight(node->leftChild);
-    int rightHeight = recursiveHeight(node->rightChild);
+    return nodeHeight(node->leftChild) - nodeHeight(node->rightChild);
+}
+
+template <typename ElementType>
+int AVLSet<ElementType>::nodeHeight(const TreeNode* node) noexcept
+{
+    return node == NULL ? -1 : node->height;
+}
+
+template <typename ElementType>
+void AVLSet<ElementType>::updateHeight(TreeNode* node) noexcept
+{
+    int leftHeight = nodeHeight(node->leftChild);
+    int rightHeight = nodeHeight(node->rightChild);
+    node->height = 1 + (leftHeight < rightHeight ? rightHeight : leftHeight);
+}
+
+template <typename ElementType>
+void AVLSet<ElementType>::unionWith(const AVLSet& other, unsigned int threadCount)
+{
+    // splitting this tree would take apart the nodes that "other" is made
+    // of, and the union of a set with itself is the set anyway
+    if(this == &other) {
+        return;
+    }
+
+    avlTree = unionRecursive(avlTree, other.avlTree, parallelLevelsFor(threadCount));
+    if(avlTree != NULL)
+        avlTree->parent = NULL;
+}
+
+template <typename ElementType>
+void AVLSet<ElementType>::intersectWith(const AVLSet& other, unsigned int threadCount)
+{
+    if(this == &other) {
+        return;
+    }
+
+    avlTree = intersectRecursive(avlTree, other.avlTree, parallelLevelsFor(threadCount));
+    if(avlTree != NULL)
+        avlTree->parent = NULL;
+}
 
-    if(node->leftChild == NULL)
-        return -(rightHeight + 1);
-    if(node->rightChild == NULL)
-        return (leftHeight + 1);
+template <typename ElementType>
+void AVLSet<ElementType>::differenceWith(const AVLSet& other, unsigned int threadCount)
+{
+    if(this == &other) {
+        delete avlTree;
+        avlTree = NULL;
+        return;
+    }
+
+    avlTree = differenceRecursive(avlTree, other.avlTree, parallelLevelsFor(threadCount));
+    if(avlTree != NULL)
+        avlTree->parent = NULL;
+}
+
+template <typename ElementType>
+unsigned int AVLSet<ElementType>::parallelLevelsFor(unsigned int threadCount) noexcept
+{
+    // each parallel level doubles the number of tasks running at once
+    unsigned int levels = 0;
+    while((1u << levels) < threadCount) {
+        levels++;
+    }
+    return levels;
+}
+
+template <typename ElementType>
+typename AVLSet<ElementType>::TreeNode* AVLSet<ElementType>::join(TreeNode* left, TreeNode* middle, TreeNode* right)
+{
+    // every element of "left" is less than middle's, and every element of
+    // "right" is greater; descend the taller side until the heights are
+    // close enough to hang both under "middle", then rebalance on the way up
+    // (unless this set was built not to balance itself)
+    if(nodeHeight(left) > nodeHeight(right) + 1) {
+        TreeNode* joined = join(left->rightChild, middle, right);
+        left->rightChild = joined;
+        joined->parent = left;
+        updateHeight(left);
+        if(shouldBalance)
+            balance(left);
+        return left;
+    }
+    if(nodeHeight(right) > nodeHeight(left) + 1) {
+        TreeNode* joined = join(left, middle, right->leftChild);
+        right->leftChild = joined;
+        joined->parent = right;
+        updateHeight(right);
+        if(shouldBalance)
+            balance(right);
+        return right;
+    }
+
+    middle->leftChild = left;
+    middle->rightChild = right;
+    if(left != NULL)
+        left->parent = middle;
+    if(right != NULL)
+        right->parent = middle;
+    updateHeight(middle);
+    return middle;
+}
+
+template <typename ElementType>
+typename AVLSet<ElementType>::TreeNode* AVLSet<ElementType>::joinPair(TreeNode* left, TreeNode* right)
+{
+    if(left == NULL) {
+        return right;
+    }
+
+    TreeNode* last;
+    TreeNode* rest = splitLast(left, last);
+    return join(rest, last, right);
+}
+
+template <typename ElementType>
+typename AVLSet<ElementType>::TreeNode* AVLSet<ElementType>::splitLast(TreeNode* root, TreeNode*& last)
+{
+    TreeNode* leftChild = root->leftChild;
+    TreeNode* rightChild = root->rightChild;
+    root->leftChild = NULL;
+    root->rightChild = NULL;
+
+    if(rightChild == NULL) {
+        last = root;
+        return leftChild;
+    }
+
+    return join(leftChild, root, splitLast(rightChild, last));
+}
+
+template <typename ElementType>
+void AVLSet<ElementType>::split(TreeNode* root, const ElementType& element, TreeNode*& left, TreeNode*& found, TreeNode*& right)
+{
+    if(root == NULL) {
+        left = NULL;
+        found = NULL;
+        right = NULL;
+        return;
+    }
+
+    TreeNode* leftChild = root->leftChild;
+    TreeNode* rightChild = root->rightChild;
+    root->leftChild = NULL;
+    root->rightChild = NULL;
+
+    if(root->element == element) {
+        left = leftChild;
+        right = rightChild;
+        found = root;
+        updateHeight(found);
+    }
+    else if(root->element > element) {
+        TreeNode* between;
+        split(leftChild, element, left, found, between);
+        right = join(between, root, rightChild);
+    }
+    else {
+        TreeNode* between;
+        split(rightChild, element, between, found, right);
+        left = join(leftChild, root, between);
+    }
+
+    if(left != NULL)
+        left->parent = NULL;
+    if(right != NULL)
+        right->parent = NULL;
+}
+
+template <typename ElementType>
+typename AVLSet<ElementType>::TreeNode* AVLSet<ElementType>::unionRecursive(TreeNode* root, const TreeNode* other, unsigned int parallelLevels)
+{
+    if(other == NULL) {
+        return root;
+    }
+    if(root == NULL) {
+        return new TreeNode(other);
+    }
+
+    TreeNode* left;
+    TreeNode* found;
+    TreeNode* right;
+    split(root, other->element, left, found, right);
+
+    if(found == NULL) {
+        found = new TreeNode(other->element);
+    }
+
+    if(parallelLevels > 0 && nodeHeight(other) >= PARALLEL_HEIGHT) {
+        std::future<TreeNode*> leftResult = std::async(std::launch::async,
+            [&]() { return unionRecursive(left, other->leftChild, parallelLevels - 1); });
+        right = unionRecursive(right, other->rightChild, parallelLevels - 1);
+        left = leftResult.get();
+    }
+    else {
+        left = unionRecursive(left, other->leftChild, 0);
+        right = unionRecursive(right, other->rightChild, 0);
+    }
+
+    return join(left, found, right);
+}
+
+template <typename ElementType>
+typename AVLSet<ElementType>::TreeNode* AVLSet<ElementType>::intersectRecursive(TreeNode* root, const TreeNode* other, unsigned int parallelLevels)
+{
+    if(root == NULL || other == NULL) {
+        delete root;
+        return NULL;
+    }
+
+    TreeNode* left;
+    TreeNode* found;
+    TreeNode* right;
+    split(root, other->element, left, found, right);
+
+    if(parallelLevels > 0 && nodeHeight(other) >= PARALLEL_HEIGHT) {
+        std::future<TreeNode*> leftResult = std::async(std::launch::async,
+            [&]() { return intersectRecursive(left, other->leftChild, parallelLevels - 1); });
+        right = intersectRecursive(right, other->rightChild, parallelLevels - 1);
+        left = leftResult.get();
+    }
+    else {
+        left = intersectRecursive(left, other->leftChild, 0);
+        right = intersectRecursive(right, other->rightChild, 0);
+    }
+
+    if(found != NULL) {
+        return join(left, found, right);
+    }
+    return joinPair(left, right);
+}
+
+template <typename ElementType>
+typename AVLSet<ElementType>::TreeNode* AVLSet<ElementType>::differenceRecursive(TreeNode* root, const TreeNode* other, unsigned int parallelLevels)
+{
+    if(root == NULL || other == NULL) {
+        return root;
+    }
+
+    TreeNode* left;
+    TreeNode* found;
+    TreeNode* right;
+    split(root, other->element, left, found, right);
+
+    // split() detached the found node from its children, so this deletes
+    // only that one node
+    delete found;
+
+    if(parallelLevels > 0 && nodeHeight(other) >= PARALLEL_HEIGHT) {
+        std::future<TreeNode*> leftResult = std::async(std::launch::async,
+            [&]() { return differenceRecursive(left, other->leftChild, parallelLevels - 1); });
+        right = differenceRecursive(right, other->rightChild, parallelLevels - 1);
+        left = leftResult.get();
+    }
+    else {
+        left = differenceRecursive(left, other->leftChild, 0);
+        right = differenceRecursive(right, other->rightChild, 0);
+    }
 
-    return leftHeight - rightHeight;
+    return joinPair(left, right);
 }
 
 #endif // AVLSET_HPP
@@ -0,0 +1,575 @@
+// AdaptiveRadixTreeSet.cpp
+//
+// ICS 46 Spring 2018
+// Project #4: Set the Controls for the Heart of the Sun
+
+#include "AdaptiveRadixTreeSet.hpp"
+
+#include <new>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+
+
+AdaptiveRadixTreeSet::AdaptiveRadixTreeSet()
+    : root{NULL}, _size{0}
+{
+}
+
+
+AdaptiveRadixTreeSet::~AdaptiveRadixTreeSet() noexcept
+{
+    destroy(root);
+}
+
+
+bool AdaptiveRadixTreeSet::isImplemented() const noexcept
+{
+    return true;
+}
+
+
+void AdaptiveRadixTreeSet::add(const std::string& element)
+{
+    if(root == NULL) {
+        root = makeLeaf(element, 0);
+        _size++;
+        return;
+    }
+
+    Node** ref = &root;
+    std::string::size_type depth = 0;
+
+    while(true) {
+        Node* node = *ref;
+        const char* prefix = prefixOf(node);
+        std::uint32_t length = node->prefixLength;
+
+        std::uint32_t match = 0;
+        while(match < length && depth + match < element.size() && prefix[match] == element[depth + match]) {
+            match++;
+        }
+
+        if(match < length) {
+            // the element leaves the node's path partway along it, so the
+            // path is split: a new node takes the shared part, with the old
+            // node (keeping the rest of its path) and the element below it
+            Node4* split = new Node4();
+            split->type = NodeType::NODE4;
+            split->terminal = false;
+            setPrefix(split, prefix, match);
+
+            unsigned char c = static_cast<unsigned char>(prefix[match]);
+            dropPrefix(node, match + 1);
+
+            Node* replacement = split;
+            addChild(replacement, c, node);
+
+            if(depth + match == element.size()) {
+                split->terminal = true;
+            }
+            else {
+                addChild(replacement, static_cast<unsigned char>(element[depth + match]), makeLeaf(element, depth + match + 1));
+            }
+
+            *ref = replacement;
+            _size++;
+            return;
+        }
+
+        depth += length;
+
+        if(depth == element.size()) {
+            if(!node->terminal) {
+                node->terminal = true;
+                _size++;
+            }
+            return;
+        }
+
+        unsigned char c = static_cast<unsigned char>(element[depth]);
+        Node* const* child = findChild(node, c);
+        if(child == NULL) {
+            addChild(*ref, c, makeLeaf(element, depth + 1));
+            _size++;
+            return;
+        }
+
+        ref = const_cast<Node**>(child);
+        depth++;
+    }
+}
+
+
+bool AdaptiveRadixTreeSet::contains(const std::string& element) const
+{
+    const Node* node = root;
+    std::string::size_type depth = 0;
+
+    while(node != NULL) {
+        std::uint32_t length = node->prefixLength;
+        if(element.size() - depth < length || std::memcmp(element.data() + depth, prefixOf(node), length) != 0) {
+            return false;
+        }
+        depth += length;
+
+        if(depth == element.size()) {
+            return node->terminal;
+        }
+
+        Node* const* child = findChild(node, static_cast<unsigned char>(element[depth]));
+        node = child == NULL ? NULL : *child;
+        depth++;
+    }
+
+    return false;
+}
+
+
+unsigned int AdaptiveRadixTreeSet::size() const noexcept
+{
+    return _size;
+}
+
+
+bool AdaptiveRadixTreeSet::containsPrefix(const std::string& prefix) const
+{
+    const Node* node = root;
+    std::string::size_type depth = 0;
+
+    while(node != NULL) {
+        // the rest of the prefix may end partway along the node's path
+        std::string::size_type length = prefix.size() - depth < node->prefixLength ? prefix.size() - depth : node->prefixLength;
+        if(std::memcmp(prefix.data() + depth, prefixOf(node), length) != 0) {
+            return false;
+        }
+        depth += length;
+
+        // every node leads to at least one word
+        if(depth == prefix.size()) {
+            return true;
+        }
+
+        Node* const* child = findChild(node, static_cast<unsigned char>(prefix[depth]));
+        node = child == NULL ? NULL : *child;
+        depth++;
+    }
+
+    return false;
+}
+
+
+void AdaptiveRadixTreeSet::inorder(VisitFunction visit) const
+{
+    if(root == NULL) {
+        return;
+    }
+
+    std::string key;
+    visitAll(root, key, visit);
+}
+
+
+AdaptiveRadixTreeSet::Node* const* AdaptiveRadixTreeSet::findChild(const Node* node, unsigned char c) noexcept
+{
+    switch(node->type) {
+    case NodeType::LEAF:
+        return NULL;
+
+    case NodeType::NODE4:
+    {
+        const Node4* n = static_cast<const Node4*>(node);
+        for(unsigned int i = 0; i < n->count; i++) {
+            if(n->keys[i] == c) {
+                return &n->children[i];
+            }
+        }
+        return NULL;
+    }
+
+    case NodeType::NODE16:
+    {
+        const Node16* n = static_cast<const Node16*>(node);
+#if defined(__SSE2__)
+        // compare the character with all sixteen keys at once; the bits of
+        // the mask that are set say which keys matched
+        __m128i matches = _mm_cmpeq_epi8(
+            _mm_set1_epi8(static_cast<char>(c)),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(n->keys)));
+        unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(matches)) & ((1u << n->count) - 1);
+        return mask == 0 ? NULL : &n->children[__builtin_ctz(mask)];
+#else
+        for(unsigned int i = 0; i < n->count; i++) {
+            if(n->keys[i] == c) {
+                return &n->children[i];
+            }
+        }
+        return NULL;
+#endif
+    }
+
+    case NodeType::NODE48:
+    {
+        const Node48* n = static_cast<const Node48*>(node);
+        return n->childIndex[c] == 0 ? NULL : &n->children[n->childIndex[c] - 1];
+    }
+
+    case NodeType::NODE256:
+    {
+        const Node256* n = static_cast<const Node256*>(node);
+        return n->children[c] == NULL ? NULL : &n->children[c];
+    }
+    }
+
+    return NULL;
+}
+
+
+void AdaptiveRadixTreeSet::addChild(Node*& ref, unsigned char c, Node* child)
+{
+    Node* node = ref;
+
+    bool full = node->type == NodeType::LEAF
+        || (node->type == NodeType::NODE4 && node->count == 4)
+        || (node->type == NodeType::NODE16 && node->count == 16)
+        || (node->type == NodeType::NODE48 && node->count == 48);
+
+    if(full) {
+        node = grow(node);
+        ref = node;
+    }
+
+    switch(node->type) {
+    case NodeType::LEAF:
+        break;
+
+    case NodeType::NODE4:
+    case NodeType::NODE16:
+    {
+        // Node4 and Node16 have the same layout apart from their sizes, and
+        // keep their keys sorted
+        unsigned char* keys;
+        Node** children;
+        if(node->type == NodeType::NODE4) {
+            keys = static_cast<Node4*>(node)->keys;
+            children = static_cast<Node4*>(node)->children;
+        }
+        else {
+            keys = static_cast<Node16*>(node)->keys;
+            children = static_cast<Node16*>(node)->children;
+        }
+
+        unsigned int i = node->count;
+        while(i > 0 && keys[i - 1] > c) {
+            keys[i] = keys[i - 1];
+            children[i] = children[i - 1];
+            i--;
+        }
+
+        keys[i] = c;
+        children[i] = child;
+        break;
+    }
+
+    case NodeType::NODE48:
+    {
+        Node48* n = static_cast<Node48*>(node);
+        n->children[n->count] = child;
+        n->childIndex[c] = static_cast<std::uint8_t>(n->count + 1);
+        break;
+    }
+
+    case NodeType::NODE256:
+        static_cast<Node256*>(node)->children[c] = child;
+        break;
+    }
+
+    node->count++;
+}
+
+
+void AdaptiveRadixTreeSet::setPrefix(Node* node, const char* characters, std::uint32_t length)
+{
+    if(length <= INLINE_PREFIX) {
+        std::memcpy(node->prefix.characters, characters, length);
+    }
+    else {
+        node->prefix.pointer = new char[length];
+        std::memcpy(node->prefix.pointer, characters, length);
+    }
+
+    node->prefixLength = length;
+}
+
+
+void AdaptiveRadixTreeSet::dropPrefix(Node* node, std::uint32_t count) noexcept
+{
+    std::uint32_t length = node->prefixLength - count;
+
+    if(node->prefixLength <= INLINE_PREFIX) {
+        std::memmove(node->prefix.characters, node->prefix.characters + count, length);
+    }
+    else if(length > INLINE_PREFIX) {
+        std::memmove(node->prefix.pointer, node->prefix.pointer + count, length);
+    }
+    else {
+        // the path now fits in the node
+        char* pointer = node->prefix.pointer;
+        std::memcpy(node->prefix.characters, pointer + count, length);
+        if(node->type != NodeType::LEAF) {
+            delete[] pointer;
+        }
+    }
+
+    node->prefixLength = length;
+}
+
+
+void AdaptiveRadixTreeSet::takePrefix(Node* from, Node* to)
+{
+    if(from->prefixLength > INLINE_PREFIX && from->type != NodeType::LEAF) {
+        to->prefix.pointer = from->prefix.pointer;
+        to->prefixLength = from->prefixLength;
+    }
+    else {
+        // a leaf's path goes away with it, so it's copied
+        setPrefix(to, prefixOf(from), from->prefixLength);
+    }
+
+    from->prefixLength = 0;
+}
+
+
+AdaptiveRadixTreeSet::Node* AdaptiveRadixTreeSet::makeLeaf(const std::string& key, std::string::size_type from)
+{
+    std::uint32_t length = static_cast<std::uint32_t>(key.size() - from);
+
+    // a long path is stored right after the leaf, in the same allocation
+    void* memory = ::operator new(sizeof(Node) + (length > INLINE_PREFIX ? length : 0));
+    Node* leaf = new (memory) Node();
+    leaf->type = NodeType::LEAF;
+    leaf->terminal = true;
+    leaf->count = 0;
+    leaf->prefixLength = length;
+
+    if(length <= INLINE_PREFIX) {
+        std::memcpy(leaf->prefix.characters, key.data() + from, length);
+    }
+    else {
+        leaf->prefix.pointer = reinterpret_cast<char*>(leaf + 1);
+        std::memcpy(leaf->prefix.pointer, key.data() + from, length);
+    }
+
+    return leaf;
+}
+
+
+void AdaptiveRadixTreeSet::destroyLeaf(Node* leaf) noexcept
+{
+    ::operator delete(leaf);
+}
+
+
+AdaptiveRadixTreeSet::Node* AdaptiveRadixTreeSet::grow(Node* node)
+{
+    switch(node->type) {
+    case NodeType::LEAF:
+    {
+        Node4* bigger = new Node4();
+        bigger->type = NodeType::NODE4;
+        bigger->terminal = node->terminal;
+        bigger->count = 0;
+        takePrefix(node, bigger);
+        destroyLeaf(node);
+        return bigger;
+    }
+
+    case NodeType::NODE4:
+    {
+        Node4* n = static_cast<Node4*>(node);
+        Node16* bigger = new Node16();
+        bigger->type = NodeType::NODE16;
+        bigger->terminal = n->terminal;
+        bigger->count = n->count;
+        takePrefix(n, bigger);
+
+        for(unsigned int i = 0; i < n->count; i++) {
+            bigger->keys[i] = n->keys[i];
+            bigger->children[i] = n->children[i];
+        }
+
+        delete n;
+        return bigger;
+    }
+
+    case NodeType::NODE16:
+    {
+        Node16* n = static_cast<Node16*>(node);
+        Node48* bigger = new Node48();
+        bigger->type = NodeType::NODE48;
+        bigger->terminal = n->terminal;
+        bigger->count = n->count;
+        takePrefix(n, bigger);
+
+        for(unsigned int i = 0; i < n->count; i++) {
+            bigger->children[i] = n->children[i];
+            bigger->childIndex[n->keys[i]] = static_cast<std::uint8_t>(i + 1);
+        }
+
+        delete n;
+        return bigger;
+    }
+
+    case NodeType::NODE48:
+    {
+        Node48* n = static_cast<Node48*>(node);
+        Node256* bigger = new Node256();
+        bigger->type = NodeType::NODE256;
+        bigger->terminal = n->terminal;
+        bigger->count = n->count;
+        takePrefix(n, bigger);
+
+        for(unsigned int c = 0; c < 256; c++) {
+            if(n->childIndex[c] != 0) {
+                bigger->children[c] = n->children[n->childIndex[c] - 1];
+            }
+        }
+
+        delete n;
+        return bigger;
+    }
+
+    case NodeType::NODE256:
+        break;
+    }
+
+    return node;
+}
+
+
+void AdaptiveRadixTreeSet::destroy(Node* node) noexcept
+{
+    if(node == NULL) {
+        return;
+    }
+
+    if(node->type == NodeType::LEAF) {
+        destroyLeaf(node);
+        return;
+    }
+
+    if(node->prefixLength > INLINE_PREFIX) {
+        delete[] node->prefix.pointer;
+    }
+
+    switch(node->type) {
+    case NodeType::LEAF:
+        break;
+
+    case NodeType::NODE4:
+    {
+        Node4* n = static_cast<Node4*>(node);
+        for(unsigned int i = 0; i < n->count; i++) {
+            destroy(n->children[i]);
+        }
+        delete n;
+        break;
+    }
+
+    case NodeType::NODE16:
+    {
+        Node16* n = static_cast<Node16*>(node);
+        for(unsigned int i = 0; i < n->count; i++) {
+            destroy(n->children[i]);
+        }
+        delete n;
+        break;
+    }
+
+    case NodeType::NODE48:
+    {
+        Node48* n = static_cast<Node48*>(node);
+        for(unsigned int i = 0; i < n->count; i++) {
+            destroy(n->children[i]);
+        }
+        delete n;
+        break;
+    }
+
+    case NodeType::NODE256:
+    {
+        Node256* n = static_cast<Node256*>(node);
+        for(unsigned int c = 0; c < 256; c++) {
+            destroy(n->children[c]);
+        }
+        delete n;
+        break;
+    }
+    }
+}
+
+
+void AdaptiveRadixTreeSet::visitAll(const Node* node, std::string& key, const VisitFunction& visit)
+{
+    std::string::size_type length = key.size();
+    key.append(prefixOf(node), node->prefixLength);
+
+    if(node->terminal) {
+        visit(key);
+    }
+
+    auto visitChild = [&](unsigned char c, const Node* child) {
+        key.push_back(static_cast<char>(c));
+        visitAll(child, key, visit);
+        key.pop_back();
+    };
+
+    switch(node->type) {
+    case NodeType::LEAF:
+        break;
+
+    case NodeType::NODE4:
+    {
+        const Node4* n = static_cast<const Node4*>(node);
+        for(unsigned int i = 0; i < n->count; i++) {
+            visitChild(n->keys[i], n->children[i]);
+        }
+        break;
+    }
+
+    case NodeType::NODE16:
+    {
+        const Node16* n = static_cast<const Node16*>(node);
+        for(unsigned int i = 0; i < n->count; i++) {
+            visitChild(n->keys[i], n->children[i]);
+        }
+        break;
+    }
+
+    case NodeType::NODE48:
+    {
+        const Node48* n = static_cast<const Node48*>(node);
+        for(unsigned int c = 0; c < 256; c++) {
+            if(n->childIndex[c] != 0) {
+                visitChild(static_cast<unsigned char>(c), n->children[n->childIndex[c] - 1]);
+            }
+        }
+        break;
+    }
+
+    case NodeType::NODE256:
+    {
+        const Node256* n = static_cast<const Node256*>(node);
+        for(unsigned int c = 0; c < 256; c++) {
+            if(n->children[c] != NULL) {
+                visitChild(static_cast<unsigned char>(c), n->children[c]);
+            }
+        }
+        break;
+    }
+    }
+
+    key.resize(length);
+}
@@ -0,0 +1,242 @@
+// AdaptiveRadixTreeSet.hpp
+//
+// ICS 46 Spring 2018
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// An AdaptiveRadixTreeSet is a Set of strings stored in an adaptive radix
+// tree (Leis, Kemper and Neumann, "The Adaptive Radix Tree", 2013).  Each
+// level of the tree consumes one character of the key, so a lookup costs
+// O(k) for a key of length k however many words there are, and words that
+// share a prefix share the nodes along it; there's no hashing of the whole
+// key, as in a HashSet, and no comparing of the whole key at every level,
+// as in an AVLSet.
+//
+// Two things keep the tree small and shallow:
+//
+//   * Adaptive nodes.  A node with children is one of four sizes, holding
+//     up to 4, 16, 48 or 256 of them, and grows to the next size when it
+//     fills up.  Node4 and Node16 keep sorted arrays of the characters of
+//     their children (Node16 searches its array with a single SSE2
+//     comparison); Node48 has a 256-entry index into 48 child pointers;
+//     Node256 has a child pointer for every character.
+//
+//   * Path compression.  Every node holds the characters that lead to it
+//     after the one its parent chose it by, so a chain of nodes with one
+//     child each collapses into one.  A leaf is a node with no children at
+//     all, which holds the whole rest of its key.
+//
+// Since a word can be a prefix of another ("CAT" and "CATS"), every node
+// also records whether a word ends there.  Characters are compared as
+// unsigned chars, so inorder() visits the words in the same order that
+// std::string's comparison sorts them.
+//
+// Besides being a Set, an AdaptiveRadixTreeSet is a prefix index:
+// forEachWordAt() finds every word that appears at a position in a text in
+// one walk down the tree (so a WordSegmenter can use one), and
+// containsPrefix() says whether any word begins with a given prefix.
+//
+// An AdaptiveRadixTreeSet can't be copied.
+
+#ifndef ADAPTIVERADIXTREESET_HPP
+#define ADAPTIVERADIXTREESET_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include "Set.hpp"
+
+
+
+class AdaptiveRadixTreeSet : public Set<std::string>
+{
+public:
+    // A VisitFunction is a function that takes a reference to a const
+    // std::string and returns no value.
+    using VisitFunction = std::function<void(const std::string&)>;
+
+public:
+    // Initializes an AdaptiveRadixTreeSet to be empty.
+    AdaptiveRadixTreeSet();
+
+    // Cleans up the AdaptiveRadixTreeSet so that it leaks no memory.
+    virtual ~AdaptiveRadixTreeSet() noexcept;
+
+    AdaptiveRadixTreeSet(const AdaptiveRadixTreeSet& s) = delete;
+    AdaptiveRadixTreeSet& operator=(const AdaptiveRadixTreeSet& s) = delete;
+
+
+    // isImplemented() returns true, since an AdaptiveRadixTreeSet is
+    // implemented.
+    virtual bool isImplemented() const noexcept override;
+
+
+    // add() adds an element to the set.  If the element is already in the
+    // set, this function has no effect.  This function runs in O(k) time
+    // for an element of length k.
+    virtual void add(const std::string& element) override;
+
+
+    // contains() returns true if the given element is already in the set,
+    // false otherwise.  This function runs in O(k) time for an element of
+    // length k.
+    virtual bool contains(const std::string& element) const override;
+
+
+    // size() returns the number of elements in the set.
+    virtual unsigned int size() const noexcept override;
+
+
+    // containsPrefix() returns true if any element of the set begins with
+    // the given prefix (every element begins with the empty one, so that's
+    // true unless the set is empty).
+    bool containsPrefix(const std::string& prefix) const;
+
+
+    // inorder() calls the given "visit" function for each of the elements
+    // in the set, in ascending order.
+    void inorder(VisitFunction visit) const;
+
+
+    // forEachWordAt() calls visit(length) for every element of the set that
+    // appears in the text at the given position, shortest first.
+    template <typename Visit>
+    void forEachWordAt(const std::string& text, std::string::size_type start, Visit visit) const;
+
+
+private:
+    enum class NodeType : std::uint8_t
+    {
+        LEAF,
+        NODE4,
+        NODE16,
+        NODE48,
+        NODE256
+    };
+
+    // The longest compressed path that's stored inside a node.
+    static constexpr unsigned int INLINE_PREFIX = 8;
+
+    // Every node begins with a Node: its type, whether a word ends at it,
+    // how many children it has, and the compressed path that leads to it.
+    // A path of up to INLINE_PREFIX characters is stored in the node; a
+    // longer one is stored elsewhere -- right after a leaf, in the same
+    // allocation, or in an array of its own for any other node -- and
+    // pointed to.
+    struct Node
+    {
+        NodeType type;
+        bool terminal;
+        std::uint16_t count;
+        std::uint32_t prefixLength;
+
+        union
+        {
+            char characters[INLINE_PREFIX];
+            char* pointer;
+        } prefix;
+    };
+
+    struct Node4 : Node
+    {
+        unsigned char keys[4];
+        Node* children[4];
+    };
+
+    struct Node16 : Node
+    {
+        unsigned char keys[16];
+        Node* children[16];
+    };
+
+    struct Node48 : Node
+    {
+        // childIndex[c] is one more than the index in "children" of the
+        // child for character c, or 0 if there isn't one
+        std::uint8_t childIndex[256];
+        Node* children[48];
+    };
+
+    struct Node256 : Node
+    {
+        Node* children[256];
+    };
+
+    Node* root;
+    unsigned int _size;
+
+    // findChild() returns the child of a node for the given character, or
+    // NULL if it has none.
+    static Node* const* findChild(const Node* node, unsigned char c) noexcept;
+
+    // addChild() adds a child to the node that "ref" points to, first
+    // replacing the node with a larger one if it's full.
+    static void addChild(Node*& ref, unsigned char c, Node* child);
+
+    static const char* prefixOf(const Node* node) noexcept;
+
+    // setPrefix() stores the path of a node other than a leaf, which has no
+    // path yet.
+    static void setPrefix(Node* node, const char* characters, std::uint32_t length);
+
+    // dropPrefix() removes the first "count" characters of a node's path.
+    static void dropPrefix(Node* node, std::uint32_t count) noexcept;
+
+    // takePrefix() moves the path of one node to another of a larger type,
+    // which has no path yet.
+    static void takePrefix(Node* from, Node* to);
+
+    static Node* makeLeaf(const std::string& key, std::string::size_type from);
+
+    static void destroyLeaf(Node* leaf) noexcept;
+
+    // grow() returns a node of the next larger type with the same contents,
+    // destroying the given one.
+    static Node* grow(Node* node);
+
+    static void destroy(Node* node) noexcept;
+
+    // visitAll() calls visit for every word in the subtree rooted at
+    // "node", whose path from the root (not counting its own prefix) is in
+    // "key".
+    static void visitAll(const Node* node, std::string& key, const VisitFunction& visit);
+};
+
+
+
+inline const char* AdaptiveRadixTreeSet::prefixOf(const Node* node) noexcept
+{
+    return node->prefixLength <= INLINE_PREFIX ? node->prefix.characters : node->prefix.pointer;
+}
+
+
+template <typename Visit>
+void AdaptiveRadixTreeSet::forEachWordAt(const std::string& text, std::string::size_type start, Visit visit) const
+{
+    const Node* node = root;
+    std::string::size_type depth = start;
+
+    while(node != NULL) {
+        std::uint32_t length = node->prefixLength;
+        if(text.size() - depth < length || std::memcmp(text.data() + depth, prefixOf(node), length) != 0) {
+            return;
+        }
+        depth += length;
+
+        if(node->terminal && depth > start) {
+            visit(depth - start);
+        }
+
+        if(depth == text.size()) {
+            return;
+        }
+
+        Node* const* child = findChild(node, static_cast<unsigned char>(text[depth]));
+        node = child == NULL ? NULL : *child;
+        depth++;
+    }
+}
+
+
+
+#endif // ADAPTIVERADIXTREESET_HPP
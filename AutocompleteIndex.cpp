@@ -0,0 +1,201 @@
+// AutocompleteIndex.cpp
+//
+// ICS 46 Spring 2018
+// Project #4: Set the Controls for the Heart of the Sun
+
+#include "AutocompleteIndex.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+
+
+AutocompleteIndex::AutocompleteIndex()
+    : nodes(1), words(1), scores(1), root{NONE}
+{
+}
+
+
+void AutocompleteIndex::add(const std::string& word, unsigned int score)
+{
+    if(word.empty()) {
+        return;
+    }
+
+    if(root == NONE) {
+        root = newNode(word[0]);
+    }
+
+    std::uint32_t current = root;
+    std::string::size_type position = 0;
+
+    // newNode() may move the nodes, so they're always looked up by index
+    // rather than held by reference across a call to it
+    while(true) {
+        char c = word[position];
+
+        if(c < nodes[current].character) {
+            if(nodes[current].lower == NONE) {
+                std::uint32_t created = newNode(c);
+                nodes[current].lower = created;
+            }
+            current = nodes[current].lower;
+        }
+        else if(c > nodes[current].character) {
+            if(nodes[current].higher == NONE) {
+                std::uint32_t created = newNode(c);
+                nodes[current].higher = created;
+            }
+            current = nodes[current].higher;
+        }
+        else if(position + 1 < word.size()) {
+            position++;
+            if(nodes[current].equal == NONE) {
+                std::uint32_t created = newNode(word[position]);
+                nodes[current].equal = created;
+            }
+            current = nodes[current].equal;
+        }
+        else {
+            break;
+        }
+    }
+
+    if(nodes[current].word == NONE) {
+        nodes[current].word = static_cast<std::uint32_t>(words.size());
+        words.push_back(word);
+        scores.push_back(score);
+    }
+    else {
+        scores[nodes[current].word] = score;
+    }
+}
+
+
+void AutocompleteIndex::build()
+{
+    completions.clear();
+    rootCompletions = buildSubtree(root);
+}
+
+
+std::vector<std::string> AutocompleteIndex::complete(const std::string& prefix, unsigned int count) const
+{
+    const std::uint32_t* best;
+    unsigned int available;
+
+    if(prefix.empty()) {
+        best = rootCompletions.data();
+        available = static_cast<unsigned int>(rootCompletions.size());
+    }
+    else {
+        std::uint32_t node = find(prefix);
+        if(node == NONE) {
+            return {};
+        }
+
+        best = completions.data() + nodes[node].firstCompletion;
+        available = nodes[node].completionCount;
+    }
+
+    if(count > available) {
+        count = available;
+    }
+
+    std::vector<std::string> result;
+    result.reserve(count);
+    for(unsigned int i = 0; i < count; i++) {
+        result.push_back(words[best[i]]);
+    }
+    return result;
+}
+
+
+unsigned int AutocompleteIndex::size() const noexcept
+{
+    return static_cast<unsigned int>(words.size() - 1);
+}
+
+
+std::uint32_t AutocompleteIndex::newNode(char character)
+{
+    nodes.push_back(Node{character, NONE, NONE, NONE, NONE, 0, 0});
+    return static_cast<std::uint32_t>(nodes.size() - 1);
+}
+
+
+std::uint32_t AutocompleteIndex::find(const std::string& prefix) const
+{
+    std::uint32_t current = root;
+    std::string::size_type position = 0;
+
+    while(current != NONE) {
+        char c = prefix[position];
+
+        if(c < nodes[current].character) {
+            current = nodes[current].lower;
+        }
+        else if(c > nodes[current].character) {
+            current = nodes[current].higher;
+        }
+        else if(++position == prefix.size()) {
+            return current;
+        }
+        else {
+            current = nodes[current].equal;
+        }
+    }
+
+    return NONE;
+}
+
+
+bool AutocompleteIndex::ranksBefore(std::uint32_t a, std::uint32_t b) const
+{
+    if(scores[a] != scores[b]) {
+        return scores[a] > scores[b];
+    }
+    return words[a] < words[b];
+}
+
+
+void AutocompleteIndex::mergeBest(std::vector<std::uint32_t>& best, const std::vector<std::uint32_t>& more) const
+{
+    std::vector<std::uint32_t> merged;
+    merged.reserve(best.size() + more.size());
+
+    std::merge(best.begin(), best.end(), more.begin(), more.end(), std::back_inserter(merged),
+        [this](std::uint32_t a, std::uint32_t b) { return ranksBefore(a, b); });
+
+    if(merged.size() > MAX_COMPLETIONS) {
+        merged.resize(MAX_COMPLETIONS);
+    }
+    best.swap(merged);
+}
+
+
+std::vector<std::uint32_t> AutocompleteIndex::buildSubtree(std::uint32_t node)
+{
+    if(node == NONE) {
+        return {};
+    }
+
+    // the completions of this node's prefix are its own word (if any) and
+    // the best words below it in the "equal" direction
+    std::vector<std::uint32_t> best;
+    if(nodes[node].word != NONE) {
+        best.push_back(nodes[node].word);
+    }
+    mergeBest(best, buildSubtree(nodes[node].equal));
+
+    nodes[node].firstCompletion = static_cast<std::uint32_t>(completions.size());
+    nodes[node].completionCount = static_cast<std::uint8_t>(best.size());
+    completions.insert(completions.end(), best.begin(), best.end());
+
+    // the nodes to either side belong to other prefixes, but the caller
+    // needs the best words from anywhere in this subtree
+    mergeBest(best, buildSubtree(nodes[node].lower));
+    mergeBest(best, buildSubtree(nodes[node].higher));
+
+    return best;
+}
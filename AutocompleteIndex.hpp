@@ -0,0 +1,162 @@
+// AutocompleteIndex.hpp
+//
+// ICS 46 Spring 2018
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// An AutocompleteIndex returns the best completions of a prefix -- the
+// words that begin with it, ranked by a score such as how often each word
+// is used.  It's meant to be loaded with the same words as the Set that a
+// WordChecker uses, and queried on every keystroke.
+//
+// The words are stored in a ternary search tree whose nodes are kept in a
+// single vector and refer to each other by index.  Each node corresponds
+// to a prefix, and build() stores, for every node, the best MAX_COMPLETIONS
+// words beginning with that prefix, in order.  complete() then only has to
+// find the node for its prefix, which takes time proportional to the
+// length of the prefix, and copy out the list it finds there; the size of
+// the dictionary doesn't matter.
+//
+// You are permitted to use the C++ Standard Library in this class.
+
+#ifndef AUTOCOMPLETEINDEX_HPP
+#define AUTOCOMPLETEINDEX_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+
+class AutocompleteIndex
+{
+public:
+    // The most completions that are kept for each prefix.
+    static constexpr unsigned int MAX_COMPLETIONS = 10;
+
+public:
+    // Initializes an AutocompleteIndex with no words in it.
+    AutocompleteIndex();
+
+
+    // add() adds a word with the given score, or changes the score of a word
+    // that was already added.  Higher scores rank first.  The completions
+    // aren't updated until build() is called.
+    void add(const std::string& word, unsigned int score = 0);
+
+
+    // addAll() adds every element of an ordered set (such as an AVLSet),
+    // all with the same score.
+    template <typename OrderedSet>
+    void addAll(const OrderedSet& words, unsigned int score = 0);
+
+
+    // build() computes the best completions for every prefix.  It runs in
+    // O(n log k) time for n nodes and k = MAX_COMPLETIONS, and must be
+    // called after adding words and before calling complete().
+    void build();
+
+
+    // complete() returns up to "count" (at most MAX_COMPLETIONS) words that
+    // begin with the given prefix, with the highest scores first and words
+    // with equal scores in ascending order.  It runs in time proportional to
+    // the length of the prefix.
+    std::vector<std::string> complete(const std::string& prefix, unsigned int count = MAX_COMPLETIONS) const;
+
+
+    // forEachWordAt() calls visit(length) for every word that appears in
+    // the text starting at the given position, shortest first, walking the
+    // tree once from the root along the text.  It doesn't depend on build().
+    template <typename Visit>
+    void forEachWordAt(const std::string& text, std::string::size_type start, Visit visit) const;
+
+
+    // size() returns the number of distinct words that have been added.
+    unsigned int size() const noexcept;
+
+
+private:
+    static constexpr std::uint32_t NONE = 0;
+
+    struct Node
+    {
+        char character;
+
+        // the nodes for smaller and larger characters at the same position,
+        // and for the next position (NONE if there are none)
+        std::uint32_t lower;
+        std::uint32_t equal;
+        std::uint32_t higher;
+
+        // the word ending at this node, or NONE
+        std::uint32_t word;
+
+        // the best completions of this node's prefix are
+        // completions[firstCompletion] onward
+        std::uint32_t firstCompletion;
+        std::uint8_t completionCount;
+    };
+
+    // nodes[0] is unused, so that index 0 can mean NONE; likewise words[0]
+    std::vector<Node> nodes;
+    std::vector<std::string> words;
+    std::vector<unsigned int> scores;
+
+    std::vector<std::uint32_t> completions;
+    std::vector<std::uint32_t> rootCompletions;
+
+    std::uint32_t root;
+
+    std::uint32_t newNode(char character);
+
+    // returns the node for the given (non-empty) prefix, or NONE
+    std::uint32_t find(const std::string& prefix) const;
+
+    // returns true if word a should be listed before word b
+    bool ranksBefore(std::uint32_t a, std::uint32_t b) const;
+
+    // merges "more" into the ranked list "best", keeping the best
+    // MAX_COMPLETIONS
+    void mergeBest(std::vector<std::uint32_t>& best, const std::vector<std::uint32_t>& more) const;
+
+    // stores the completions of every node in the subtree rooted at "node",
+    // and returns the best words anywhere in that subtree
+    std::vector<std::uint32_t> buildSubtree(std::uint32_t node);
+};
+
+
+
+template <typename OrderedSet>
+void AutocompleteIndex::addAll(const OrderedSet& words, unsigned int score)
+{
+    words.inorder([&](const std::string& word) { add(word, score); });
+}
+
+
+template <typename Visit>
+void AutocompleteIndex::forEachWordAt(const std::string& text, std::string::size_type start, Visit visit) const
+{
+    std::uint32_t current = root;
+    std::string::size_type position = start;
+
+    while(current != NONE && position < text.size()) {
+        char c = text[position];
+
+        if(c < nodes[current].character) {
+            current = nodes[current].lower;
+        }
+        else if(c > nodes[current].character) {
+            current = nodes[current].higher;
+        }
+        else {
+            position++;
+            if(nodes[current].word != NONE) {
+                visit(position - start);
+            }
+            current = nodes[current].equal;
+        }
+    }
+}
+
+
+
+#endif // AUTOCOMPLETEINDEX_HPP
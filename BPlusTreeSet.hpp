@@ -0,0 +1,702 @@
+// BPlusTreeSet.hpp
+//
+// ICS 46 Spring 2018
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// A BPlusTreeSet is an implementation of a Set that is a B+-tree.  Each
+// node holds up to ORDER keys, so the tree is only a handful of levels
+// deep even for very large sets, and a lookup touches a handful of nodes
+// instead of the roughly log2(n) nodes an AVLSet touches.  The elements
+// themselves are all stored in the leaves, which are linked together in
+// ascending order; the internal nodes hold copies of keys that separate
+// their children.
+//
+// Alongside its keys, every node stores a fixed-width integer "prefix" of
+// each key, chosen so that comparing the prefixes of two keys gives the
+// same answer as comparing the keys themselves whenever the prefixes are
+// different.  Searching a node compares the prefix of the element being
+// sought against all of the node's prefixes at once (with AVX2, when it's
+// available, and otherwise with a simple loop the compiler can vectorize),
+// and only reads the full keys whose prefixes tie with the element's.
+//
+// BPlusTreeKeyPrefix, below, decides what the prefix of a key is.  The
+// general version gives every key the same prefix, which is always correct
+// but means every comparison is settled by the full keys; the version for
+// std::string uses the key's first eight bytes.  So for keys of any other
+// type (unless BPlusTreeKeyPrefix is specialized for it), the SIMD search
+// of the prefixes does nothing useful: every key in a node ties, and the
+// search compares the full keys one by one, like an ordinary B+-tree.
+
+#ifndef BPLUSTREESET_HPP
+#define BPLUSTREESET_HPP
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <string>
+#include <utility>
+#include "ParallelBuild.hpp"
+#include "Set.hpp"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+
+
+// BPlusTreeKeyPrefix computes the prefix of a key.  If the prefix of one
+// key is less than the prefix of another, the first key must be less than
+// the second.  (Keys whose prefixes are equal may compare any way at all.)
+
+template <typename ElementType>
+class BPlusTreeKeyPrefix
+{
+public:
+    static std::int64_t of(const ElementType& element) noexcept;
+};
+
+
+// Every key that isn't a std::string has the same, constant prefix.
+
+template <typename ElementType>
+std::int64_t BPlusTreeKeyPrefix<ElementType>::of(const ElementType&) noexcept
+{
+    return 0;
+}
+
+
+// The prefix of a string is its first eight bytes, read as a big-endian
+// integer (with shorter strings padded with zero bytes), so that integer
+// order matches the order in which std::string compares its bytes.  The
+// top bit is flipped so that the prefixes can be compared as signed
+// integers, which is what the SIMD comparison instructions support.
+
+template <>
+inline std::int64_t BPlusTreeKeyPrefix<std::string>::of(const std::string& element) noexcept
+{
+    std::uint64_t prefix = 0;
+    std::string::size_type length = element.size() < 8 ? element.size() : 8;
+
+    for(std::string::size_type i = 0; i < 8; i++) {
+        prefix <<= 8;
+        if(i < length) {
+            prefix |= static_cast<unsigned char>(element[i]);
+        }
+    }
+
+    return static_cast<std::int64_t>(prefix ^ (std::uint64_t{1} << 63));
+}
+
+
+
+template <typename ElementType>
+class BPlusTreeSet : public Set<ElementType>
+{
+public:
+    // A VisitFunction is a function that takes a reference to a const
+    // ElementType and returns no value.
+    using VisitFunction = std::function<void(const ElementType&)>;
+
+    // The most keys a node can hold.  A node's prefixes then fill four
+    // cache lines, and a search reads those plus the keys that tie.
+    static constexpr unsigned int ORDER = 32;
+
+public:
+    // Initializes a BPlusTreeSet to be empty.
+    BPlusTreeSet();
+
+    // Cleans up the BPlusTreeSet so that it leaks no memory.
+    virtual ~BPlusTreeSet() noexcept;
+
+    // Initializes a new BPlusTreeSet to be a copy of an existing one.
+    BPlusTreeSet(const BPlusTreeSet& s);
+
+    // Initializes a new BPlusTreeSet whose contents are moved from an
+    // expiring one.
+    BPlusTreeSet(BPlusTreeSet&& s) noexcept;
+
+    // Assigns an existing BPlusTreeSet into another.
+    BPlusTreeSet& operator=(const BPlusTreeSet& s);
+
+    // Assigns an expiring BPlusTreeSet into another.
+    BPlusTreeSet& operator=(BPlusTreeSet&& s) noexcept;
+
+
+    // isImplemented() returns true, since a BPlusTreeSet is implemented.
+    virtual bool isImplemented() const noexcept override;
+
+
+    // add() adds an element to the set.  If the element is already in the set,
+    // this function has no effect.  This function always runs in O(log n) time
+    // when there are n elements in the B+-tree.
+    virtual void add(const ElementType& element) override;
+
+
+    // addAll() adds an array of elements to the set, skipping any that are
+    // already in it.  It sorts a copy of the elements using the given number
+    // of threads, merges them with the elements already in the tree, and
+    // then rebuilds the tree bottom-up in linear time, with every node as
+    // full as it can be without needing to split on the next add().
+    void addAll(const ElementType* elements, unsigned int count, unsigned int threadCount = defaultThreadCount());
+
+
+    // contains() returns true if the given element is already in the set,
+    // false otherwise.  This function always runs in O(log n) time when
+    // there are n elements in the B+-tree.
+    virtual bool contains(const ElementType& element) const override;
+
+
+    // size() returns the number of elements in the set.
+    virtual unsigned int size() const noexcept override;
+
+
+    // height() returns the height of the B+-tree, counted in nodes, so that
+    // a tree that is a single leaf has height 0.  By definition, the height
+    // of an empty tree is -1.
+    int height() const noexcept;
+
+
+    // preorder(), inorder() and postorder() call the given "visit" function
+    // for each of the elements in the set.  Because the elements are only
+    // stored in the leaves, which are always visited left to right, all
+    // three traversals visit the elements in ascending order; they're all
+    // here so that a BPlusTreeSet can be used wherever an AVLSet's
+    // traversals are.
+    void preorder(VisitFunction visit) const;
+    void inorder(VisitFunction visit) const;
+    void postorder(VisitFunction visit) const;
+
+
+private:
+    class Node {
+    public:
+        bool isLeaf;
+        unsigned int count;
+
+        // prefixes[i] is the prefix of keys[i]; the unused slots hold the
+        // largest possible prefix, so a search can compare all ORDER slots
+        // without first checking which of them are in use.
+        alignas(64) std::int64_t prefixes[ORDER];
+        ElementType keys[ORDER];
+
+        // internal nodes have count + 1 children, where keys[i] is the
+        // smallest element below children[i + 1]
+        Node* children[ORDER + 1];
+
+        // leaves are linked to the next leaf in ascending order
+        Node* next;
+
+        explicit Node(bool isLeaf);
+        ~Node() noexcept;
+
+        // inserts a key (and, in an internal node, the child that follows
+        // it) at the given position, shifting the rest to the right
+        void insertAt(unsigned int position, const ElementType& key, Node* rightChild);
+    };
+
+    Node* root;
+    unsigned int _size;
+
+    // Returns the number of keys in the node whose prefix is less than the
+    // given one.
+    static unsigned int countPrefixesBelow(const Node* node, std::int64_t prefix) noexcept;
+
+    // Returns the position of the first key in the node that is not less
+    // than the element (lower bound) or that is greater than it (upper
+    // bound).
+    static unsigned int lowerBound(const Node* node, const ElementType& element, std::int64_t prefix);
+    static unsigned int upperBound(const Node* node, const ElementType& element, std::int64_t prefix);
+
+    // Inserts the element into the subtree rooted at "node".  If the node
+    // had to be split, the new right sibling is returned and "separator" is
+    // set to the smallest element below it; otherwise, NULL is returned.
+    Node* recursiveAdd(Node* node, const ElementType& element, std::int64_t prefix, bool& added, ElementType& separator);
+
+    // Splits a full node in half, returning the new right half.
+    Node* split(Node* node, ElementType& separator);
+
+    // Builds a tree bottom-up from sorted, distinct elements.
+    void bulkBuild(const ElementType* sortedElements, unsigned int count);
+
+    // Makes a deep copy of a subtree, linking the copied leaves together.
+    Node* copyNode(const Node* node, Node*& previousLeaf);
+
+    // Returns the leftmost leaf of the tree, or NULL if it's empty.
+    const Node* firstLeaf() const noexcept;
+};
+
+
+
+template <typename ElementType>
+BPlusTreeSet<ElementType>::Node::Node(bool isLeaf)
+    : isLeaf{isLeaf}, count{0}, next{NULL}
+{
+    for(unsigned int i = 0; i < ORDER; i++) {
+        prefixes[i] = std::numeric_limits<std::int64_t>::max();
+    }
+    for(unsigned int i = 0; i <= ORDER; i++) {
+        children[i] = NULL;
+    }
+}
+
+
+template <typename ElementType>
+BPlusTreeSet<ElementType>::Node::~Node() noexcept
+{
+    if(!isLeaf) {
+        for(unsigned int i = 0; i <= count; i++) {
+            delete children[i];
+        }
+    }
+}
+
+
+template <typename ElementType>
+void BPlusTreeSet<ElementType>::Node::insertAt(unsigned int position, const ElementType& key, Node* rightChild)
+{
+    for(unsigned int i = count; i > position; i--) {
+        keys[i] = std::move(keys[i - 1]);
+        prefixes[i] = prefixes[i - 1];
+        children[i + 1] = children[i];
+    }
+
+    keys[position] = key;
+    prefixes[position] = BPlusTreeKeyPrefix<ElementType>::of(key);
+    children[position + 1] = rightChild;
+    count++;
+}
+
+
+template <typename ElementType>
+BPlusTreeSet<ElementType>::BPlusTreeSet()
+    : root{NULL}, _size{0}
+{
+}
+
+
+template <typename ElementType>
+BPlusTreeSet<ElementType>::~BPlusTreeSet() noexcept
+{
+    delete root;
+}
+
+
+template <typename ElementType>
+BPlusTreeSet<ElementType>::BPlusTreeSet(const BPlusTreeSet& s)
+    : root{NULL}, _size{s._size}
+{
+    Node* previousLeaf = NULL;
+    if(s.root != NULL) {
+        root = copyNode(s.root, previousLeaf);
+    }
+}
+
+
+template <typename ElementType>
+BPlusTreeSet<ElementType>::BPlusTreeSet(BPlusTreeSet&& s) noexcept
+    : root{s.root}, _size{s._size}
+{
+    s.root = NULL;
+    s._size = 0;
+}
+
+
+template <typename ElementType>
+BPlusTreeSet<ElementType>& BPlusTreeSet<ElementType>::operator=(const BPlusTreeSet& s)
+{
+    if(this != &s) {
+        BPlusTreeSet copy{s};
+        std::swap(root, copy.root);
+        std::swap(_size, copy._size);
+    }
+    return *this;
+}
+
+
+template <typename ElementType>
+BPlusTreeSet<ElementType>& BPlusTreeSet<ElementType>::operator=(BPlusTreeSet&& s) noexcept
+{
+    std::swap(root, s.root);
+    std::swap(_size, s._size);
+    return *this;
+}
+
+
+template <typename ElementType>
+bool BPlusTreeSet<ElementType>::isImplemented() const noexcept
+{
+    return true;
+}
+
+
+template <typename ElementType>
+void BPlusTreeSet<ElementType>::add(const ElementType& element)
+{
+    if(root == NULL) {
+        root = new Node{true};
+    }
+
+    bool added = false;
+    ElementType separator{};
+    Node* sibling = recursiveAdd(root, element, BPlusTreeKeyPrefix<ElementType>::of(element), added, separator);
+
+    if(sibling != NULL) {
+        // the root was split, so the tree grows a level
+        Node* newRoot = new Node{false};
+        newRoot->children[0] = root;
+        newRoot->insertAt(0, separator, sibling);
+        root = newRoot;
+    }
+
+    if(added) {
+        _size++;
+    }
+}
+
+
+template <typename ElementType>
+void BPlusTreeSet<ElementType>::addAll(const ElementType* elements, unsigned int count, unsigned int threadCount)
+{
+    if(count == 0) {
+        return;
+    }
+
+    ElementType* added = new ElementType[count];
+    for(unsigned int i = 0; i < count; i++) {
+        added[i] = elements[i];
+    }
+    parallelSort(added, count, threadCount);
+
+    // merge with the leaves, which are already in order, dropping duplicates
+    ElementType* merged = new ElementType[_size + count];
+    unsigned int mergedCount = 0;
+    const Node* leaf = firstLeaf();
+    unsigned int position = 0;
+    unsigned int j = 0;
+
+    while(leaf != NULL || j < count) {
+        const ElementType* smallest;
+        if(j == count || (leaf != NULL && !(added[j] < leaf->keys[position]))) {
+            smallest = &leaf->keys[position];
+            if(++position == leaf->count) {
+                leaf = leaf->next;
+                position = 0;
+            }
+        }
+        else {
+            smallest = &added[j++];
+        }
+
+        if(mergedCount == 0 || !(merged[mergedCount - 1] == *smallest)) {
+            merged[mergedCount++] = *smallest;
+        }
+    }
+
+    delete[] added;
+
+    bulkBuild(merged, mergedCount);
+    delete[] merged;
+}
+
+
+template <typename ElementType>
+bool BPlusTreeSet<ElementType>::contains(const ElementType& element) const
+{
+    if(root == NULL) {
+        return false;
+    }
+
+    std::int64_t prefix = BPlusTreeKeyPrefix<ElementType>::of(element);
+    const Node* node = root;
+
+    while(!node->isLeaf) {
+        node = node->children[upperBound(node, element, prefix)];
+    }
+
+    unsigned int position = lowerBound(node, element, prefix);
+    return position < node->count
+        && node->prefixes[position] == prefix
+        && node->keys[position] == element;
+}
+
+
+template <typename ElementType>
+unsigned int BPlusTreeSet<ElementType>::size() const noexcept
+{
+    return _size;
+}
+
+
+template <typename ElementType>
+int BPlusTreeSet<ElementType>::height() const noexcept
+{
+    int h = -1;
+    for(const Node* node = root; node != NULL; node = node->isLeaf ? NULL : node->children[0]) {
+        h++;
+    }
+    return h;
+}
+
+
+template <typename ElementType>
+void BPlusTreeSet<ElementType>::preorder(VisitFunction visit) const
+{
+    inorder(visit);
+}
+
+
+template <typename ElementType>
+void BPlusTreeSet<ElementType>::inorder(VisitFunction visit) const
+{
+    for(const Node* leaf = firstLeaf(); leaf != NULL; leaf = leaf->next) {
+        for(unsigned int i = 0; i < leaf->count; i++) {
+            visit(leaf->keys[i]);
+        }
+    }
+}
+
+
+template <typename ElementType>
+void BPlusTreeSet<ElementType>::postorder(VisitFunction visit) const
+{
+    inorder(visit);
+}
+
+
+template <typename ElementType>
+unsigned int BPlusTreeSet<ElementType>::countPrefixesBelow(const Node* node, std::int64_t prefix) noexcept
+{
+#if defined(__AVX2__)
+    __m256i target = _mm256_set1_epi64x(prefix);
+    unsigned int below = 0;
+
+    for(unsigned int i = 0; i < ORDER; i += 4) {
+        __m256i keys = _mm256_load_si256(reinterpret_cast<const __m256i*>(node->prefixes + i));
+        __m256i less = _mm256_cmpgt_epi64(target, keys);
+        below += __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(less)));
+    }
+
+    return below;
+#else
+    // unused slots hold the largest prefix, which is never below anything,
+    // so this loop has a fixed trip count and no branches
+    unsigned int below = 0;
+    for(unsigned int i = 0; i < ORDER; i++) {
+        below += node->prefixes[i] < prefix;
+    }
+    return below;
+#endif
+}
+
+
+template <typename ElementType>
+unsigned int BPlusTreeSet<ElementType>::lowerBound(const Node* node, const ElementType& element, std::int64_t prefix)
+{
+    unsigned int position = countPrefixesBelow(node, prefix);
+
+    // only keys whose prefixes tie with the element's need a full compare
+    while(position < node->count && node->prefixes[position] == prefix && node->keys[position] < element) {
+        position++;
+    }
+    return position;
+}
+
+
+template <typename ElementType>
+unsigned int BPlusTreeSet<ElementType>::upperBound(const Node* node, const ElementType& element, std::int64_t prefix)
+{
+    unsigned int position = countPrefixesBelow(node, prefix);
+
+    while(position < node->count && node->prefixes[position] == prefix && !(element < node->keys[position])) {
+        position++;
+    }
+    return position;
+}
+
+
+template <typename ElementType>
+typename BPlusTreeSet<ElementType>::Node* BPlusTreeSet<ElementType>::recursiveAdd(
+    Node* node, const ElementType& element, std::int64_t prefix, bool& added, ElementType& separator)
+{
+    if(node->isLeaf) {
+        unsigned int position = lowerBound(node, element, prefix);
+        if(position < node->count && node->prefixes[position] == prefix && node->keys[position] == element) {
+            return NULL;
+        }
+
+        node->insertAt(position, element, NULL);
+        added = true;
+    }
+    else {
+        unsigned int position = upperBound(node, element, prefix);
+        ElementType childSeparator{};
+        Node* sibling = recursiveAdd(node->children[position], element, prefix, added, childSeparator);
+
+        if(sibling == NULL) {
+            return NULL;
+        }
+        node->insertAt(position, childSeparator, sibling);
+    }
+
+    if(node->count < ORDER) {
+        return NULL;
+    }
+    return split(node, separator);
+}
+
+
+template <typename ElementType>
+typename BPlusTreeSet<ElementType>::Node* BPlusTreeSet<ElementType>::split(Node* node, ElementType& separator)
+{
+    constexpr unsigned int half = ORDER / 2;
+    Node* sibling = new Node{node->isLeaf};
+
+    if(node->isLeaf) {
+        // leaves keep every element, so the separator is a copy of the
+        // right half's first key
+        for(unsigned int i = half; i < ORDER; i++) {
+            sibling->keys[i - half] = std::move(node->keys[i]);
+            sibling->prefixes[i - half] = node->prefixes[i];
+            node->prefixes[i] = std::numeric_limits<std::int64_t>::max();
+        }
+        sibling->count = ORDER - half;
+        node->count = half;
+
+        separator = sibling->keys[0];
+        sibling->next = node->next;
+        node->next = sibling;
+    }
+    else {
+        // internal nodes move their middle key up to the parent
+        separator = std::move(node->keys[half]);
+        node->prefixes[half] = std::numeric_limits<std::int64_t>::max();
+        sibling->children[0] = node->children[half + 1];
+        node->children[half + 1] = NULL;
+
+        for(unsigned int i = half + 1; i < ORDER; i++) {
+            sibling->keys[i - half - 1] = std::move(node->keys[i]);
+            sibling->prefixes[i - half - 1] = node->prefixes[i];
+            sibling->children[i - half] = node->children[i + 1];
+            node->prefixes[i] = std::numeric_limits<std::int64_t>::max();
+            node->children[i + 1] = NULL;
+        }
+        sibling->count = ORDER - half - 1;
+        node->count = half;
+    }
+
+    return sibling;
+}
+
+
+template <typename ElementType>
+void BPlusTreeSet<ElementType>::bulkBuild(const ElementType* sortedElements, unsigned int count)
+{
+    delete root;
+    root = NULL;
+    _size = count;
+
+    if(count == 0) {
+        return;
+    }
+
+    // a node splits when it reaches ORDER keys, so fill each one to ORDER - 1
+    // keys (and internal nodes to ORDER children), spreading the elements
+    // evenly so no node ends up nearly empty
+    constexpr unsigned int fullLeaf = ORDER - 1;
+    unsigned int levelCount = (count + fullLeaf - 1) / fullLeaf;
+
+    Node** level = new Node*[levelCount];
+    const ElementType** smallest = new const ElementType*[levelCount];
+    Node* previousLeaf = NULL;
+
+    for(unsigned int n = 0; n < levelCount; n++) {
+        unsigned int begin, end;
+        chunkBounds(count, levelCount, n, begin, end);
+
+        Node* leaf = new Node{true};
+        for(unsigned int i = begin; i < end; i++) {
+            leaf->keys[i - begin] = sortedElements[i];
+            leaf->prefixes[i - begin] = BPlusTreeKeyPrefix<ElementType>::of(sortedElements[i]);
+        }
+        leaf->count = end - begin;
+
+        if(previousLeaf != NULL) {
+            previousLeaf->next = leaf;
+        }
+        previousLeaf = leaf;
+
+        level[n] = leaf;
+        smallest[n] = &sortedElements[begin];
+    }
+
+    while(levelCount > 1) {
+        unsigned int parentCount = (levelCount + ORDER - 1) / ORDER;
+
+        for(unsigned int n = 0; n < parentCount; n++) {
+            unsigned int begin, end;
+            chunkBounds(levelCount, parentCount, n, begin, end);
+
+            Node* parent = new Node{false};
+            parent->children[0] = level[begin];
+            for(unsigned int i = begin + 1; i < end; i++) {
+                parent->keys[i - begin - 1] = *smallest[i];
+                parent->prefixes[i - begin - 1] = BPlusTreeKeyPrefix<ElementType>::of(*smallest[i]);
+                parent->children[i - begin] = level[i];
+            }
+            parent->count = end - begin - 1;
+
+            // n <= begin, so these never overwrite entries still to be read
+            level[n] = parent;
+            smallest[n] = smallest[begin];
+        }
+
+        levelCount = parentCount;
+    }
+
+    root = level[0];
+
+    delete[] smallest;
+    delete[] level;
+}
+
+
+template <typename ElementType>
+typename BPlusTreeSet<ElementType>::Node* BPlusTreeSet<ElementType>::copyNode(const Node* node, Node*& previousLeaf)
+{
+    Node* copy = new Node{node->isLeaf};
+    copy->count = node->count;
+
+    for(unsigned int i = 0; i < node->count; i++) {
+        copy->keys[i] = node->keys[i];
+        copy->prefixes[i] = node->prefixes[i];
+    }
+
+    if(node->isLeaf) {
+        if(previousLeaf != NULL) {
+            previousLeaf->next = copy;
+        }
+        previousLeaf = copy;
+    }
+    else {
+        for(unsigned int i = 0; i <= node->count; i++) {
+            copy->children[i] = copyNode(node->children[i], previousLeaf);
+        }
+    }
+
+    return copy;
+}
+
+
+template <typename ElementType>
+const typename BPlusTreeSet<ElementType>::Node* BPlusTreeSet<ElementType>::firstLeaf() const noexcept
+{
+    const Node* node = root;
+    while(node != NULL && !node->isLeaf) {
+        node = node->children[0];
+    }
+    return node;
+}
+
+
+
+#endif // BPLUSTREESET_HPP
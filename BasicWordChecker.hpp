@@ -0,0 +1,579 @@
+// BasicWordChecker.hpp
+//
+// ICS 46 Spring 2018
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// A BasicWordChecker checks words and finds suggestions using the five
+// techniques described in the project write-up.  It's the one
+// implementation of them: a WordChecker hands its work to a BasicWordChecker
+// specialized on the concrete type of its set (a HashSet, an AVLSet, or any
+// other), rather than holding a reference to a Set and calling contains()
+// virtually.  A call to contains() that's qualified with the set's type
+// isn't dispatched virtually, so the compiler can inline the lookups into
+// the loops that generate the candidates, which are edited in place rather
+// than rebuilt for each lookup.
+//
+// Which techniques run is chosen at compile time by a technique policy: a
+// type with a static constexpr bool for each technique, such as one of the
+// Techniques below.  The techniques left out aren't compiled at all.
+//
+// How each candidate is looked up, and which candidates are skipped, is
+// decided by hooks that depend on the set's type:
+//
+//   * If the set's type has a containsMany() member function, the
+//     candidates of techniques 2 and 4 are looked up in groups of 26 with
+//     it.
+//
+//   * If the set's type has hasLength() and hasShape() member functions
+//     (as a LengthPartitionedSet does), every candidate whose length and
+//     first letter match no word in the set is skipped without a lookup.
+//
+//   * If the set is a HashSet that uses PolynomialHash::hash, each
+//     candidate's hash is computed in constant time from the word's prefix
+//     hashes and the candidate is compared against the elements in its
+//     bucket, rather than being hashed from scratch.
+//
+// Probes are counted by a probe policy (see SuggestionBudget.hpp), so the
+// same techniques run with a SuggestionBudget and without one.
+//
+// Because of the qualified calls, the set must really be of type SetType,
+// not of a type derived from it that overrides contains().  If SetType is
+// abstract (such as Set<std::string> itself), contains() is called
+// virtually instead.
+//
+// You are permitted to use the C++ Standard Library in this class.
+
+#ifndef BASICWORDCHECKER_HPP
+#define BASICWORDCHECKER_HPP
+
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "HashSet.hpp"
+#include "PolynomialHash.hpp"
+#include "SuggestionBudget.hpp"
+#include "WordCheckerStats.hpp"
+
+
+
+// Techniques is a technique policy that runs the techniques whose template
+// arguments are true: swapping adjacent letters (technique 1), inserting a
+// letter (2), deleting a letter (3), replacing a letter (4), and splitting
+// the word in two (5).
+template <bool Swaps, bool Insertions, bool Deletions, bool Replacements, bool Splits>
+struct Techniques
+{
+    static constexpr bool swaps = Swaps;
+    static constexpr bool insertions = Insertions;
+    static constexpr bool deletions = Deletions;
+    static constexpr bool replacements = Replacements;
+    static constexpr bool splits = Splits;
+};
+
+using AllTechniques = Techniques<true, true, true, true, true>;
+
+// the techniques that find words one edit away, without splitting
+using EditTechniques = Techniques<true, true, true, true, false>;
+
+// the technique that splits the word in two, alone
+using SplitTechniques = Techniques<false, false, false, false, true>;
+
+
+
+// HasContainsMany<SetType>::value is true if SetType has a containsMany()
+// member function like the HashSet's.
+template <typename SetType, typename = void>
+struct HasContainsMany : std::false_type
+{
+};
+
+template <typename SetType>
+struct HasContainsMany<SetType, std::void_t<decltype(std::declval<const SetType&>().containsMany(
+    std::declval<const std::string*>(), 0u, std::declval<bool*>()))>> : std::true_type
+{
+};
+
+
+// HasShapes<SetType>::value is true if SetType has hasLength() and
+// hasShape() member functions like the LengthPartitionedSet's.
+template <typename SetType, typename = void>
+struct HasShapes : std::false_type
+{
+};
+
+template <typename SetType>
+struct HasShapes<SetType, std::void_t<
+    decltype(std::declval<const SetType&>().hasLength(std::string::size_type{0})),
+    decltype(std::declval<const SetType&>().hasShape(std::string::size_type{0}, 'A'))>> : std::true_type
+{
+};
+
+
+
+template <typename SetType, typename TechniquePolicy = AllTechniques>
+class BasicWordChecker
+{
+public:
+    // Initializes a BasicWordChecker that looks words up in the given set,
+    // which must outlive it.
+    explicit BasicWordChecker(const SetType& words);
+
+
+    // wordExists() returns true if the given word is spelled correctly,
+    // false otherwise.
+    bool wordExists(const std::string& word) const;
+
+
+    // findSuggestions() returns a vector containing suggested alternative
+    // spellings for the given word, using the techniques that the technique
+    // policy selects, in the order they're numbered.
+    std::vector<std::string> findSuggestions(const std::string& word) const;
+
+
+    // This version of findSuggestions() stops as soon as the given budget
+    // runs out.  So that the suggestions found by then are the most likely
+    // ones, it runs the techniques from cheapest to most expensive: swaps
+    // (n - 1 probes for a word of n letters), deletions (n), splits (up to
+    // 2n), replacements (26n), and finally insertions (26n + 26).
+    SuggestionResult findSuggestions(const std::string& word, const SuggestionBudget& budget) const;
+
+
+private:
+    const SetType& words;
+
+    // whether the set is a HashSet that uses PolynomialHash::hash
+    bool hashed;
+
+    // only a HashSet of strings can look elements up by their hashes
+    static constexpr bool MAY_BE_HASHED = std::is_same<SetType, HashSet<std::string>>::value;
+
+    // lookUp() looks a candidate up in the set, without a virtual call
+    // unless SetType is abstract.
+    bool lookUp(const std::string& candidate) const;
+
+    // mayExist() returns false only if the set is known to have no words of
+    // the given length (beginning with the given character).
+    bool mayExist(std::string::size_type length) const noexcept;
+    bool mayExist(std::string::size_type length, char first) const noexcept;
+
+    // withHashes() calls run() with the prefix hashes of the word if the set
+    // is hashed, or with NULL if it isn't.
+    template <typename Run>
+    void withHashes(const std::string& word, Run run) const;
+
+    // probe() counts a probe of the candidate against the probe policy and,
+    // if it's allowed, looks the candidate up.  If "hashes" isn't NULL,
+    // rawHash() returns the candidate's raw hash.
+    template <typename Probes, typename RawHash>
+    bool probe(const std::string& candidate, Probes& probes, const PolynomialHash::Word* hashes, RawHash rawHash) const;
+
+    // probeLetters() probes the candidates that have each letter from 'A'
+    // through 'Z' at position i of "candidate", adding the ones that are
+    // found to the suggestions; rawHash(c) returns the raw hash of the one
+    // with c there.  If SetType has containsMany() (or the set is hashed),
+    // they're looked up as a group; otherwise, each is looked up as it's
+    // made, in place in "candidate".
+    template <typename Probes, typename RawHash>
+    void probeLetters(std::vector<std::string>& suggestions, std::string& candidate, std::string::size_type i,
+        Probes& probes, const PolynomialHash::Word* hashes, RawHash rawHash) const;
+
+    template <typename Probes>
+    void findSwaps(std::vector<std::string>& suggestions, const std::string& word, const PolynomialHash::Word* hashes, Probes& probes) const;
+
+    template <typename Probes>
+    void findInsertions(std::vector<std::string>& suggestions, const std::string& word, const PolynomialHash::Word* hashes, Probes& probes) const;
+
+    template <typename Probes>
+    void findDeletions(std::vector<std::string>& suggestions, const std::string& word, const PolynomialHash::Word* hashes, Probes& probes) const;
+
+    template <typename Probes>
+    void findReplacements(std::vector<std::string>& suggestions, const std::string& word, const PolynomialHash::Word* hashes, Probes& probes) const;
+
+    template <typename Probes>
+    void findSplits(std::vector<std::string>& suggestions, const std::string& word, const PolynomialHash::Word* hashes, Probes& probes) const;
+};
+
+
+
+template <typename SetType, typename TechniquePolicy>
+BasicWordChecker<SetType, TechniquePolicy>::BasicWordChecker(const SetType& words)
+    : words{words}, hashed{false}
+{
+    if constexpr(MAY_BE_HASHED) {
+        hashed = words.hashFunctionIs(&PolynomialHash::hash);
+    }
+}
+
+
+template <typename SetType, typename TechniquePolicy>
+bool BasicWordChecker<SetType, TechniquePolicy>::wordExists(const std::string& word) const
+{
+    return lookUp(word);
+}
+
+
+template <typename SetType, typename TechniquePolicy>
+std::vector<std::string> BasicWordChecker<SetType, TechniquePolicy>::findSuggestions(const std::string& word) const
+{
+    std::vector<std::string> suggestions;
+    UnlimitedProbes probes;
+
+    withHashes(word, [&](const PolynomialHash::Word* hashes) {
+        if constexpr(TechniquePolicy::swaps) {
+            findSwaps(suggestions, word, hashes, probes);
+        }
+        if constexpr(TechniquePolicy::insertions) {
+            findInsertions(suggestions, word, hashes, probes);
+        }
+        if constexpr(TechniquePolicy::deletions) {
+            findDeletions(suggestions, word, hashes, probes);
+        }
+        if constexpr(TechniquePolicy::replacements) {
+            findReplacements(suggestions, word, hashes, probes);
+        }
+        if constexpr(TechniquePolicy::splits) {
+            findSplits(suggestions, word, hashes, probes);
+        }
+    });
+
+    return suggestions;
+}
+
+
+template <typename SetType, typename TechniquePolicy>
+SuggestionResult BasicWordChecker<SetType, TechniquePolicy>::findSuggestions(
+    const std::string& word, const SuggestionBudget& budget) const
+{
+    SuggestionResult result;
+    ProbeBudget probes{budget};
+
+    withHashes(word, [&](const PolynomialHash::Word* hashes) {
+        // cheapest first, so that a small budget still covers the
+        // techniques most likely to find something
+        if constexpr(TechniquePolicy::swaps) {
+            findSwaps(result.suggestions, word, hashes, probes);
+        }
+        if constexpr(TechniquePolicy::deletions) {
+            findDeletions(result.suggestions, word, hashes, probes);
+        }
+        if constexpr(TechniquePolicy::splits) {
+            findSplits(result.suggestions, word, hashes, probes);
+        }
+        if constexpr(TechniquePolicy::replacements) {
+            findReplacements(result.suggestions, word, hashes, probes);
+        }
+        if constexpr(TechniquePolicy::insertions) {
+            findInsertions(result.suggestions, word, hashes, probes);
+        }
+    });
+
+    result.truncated = probes.exhausted();
+    result.probes = probes.probes();
+    return result;
+}
+
+
+template <typename SetType, typename TechniquePolicy>
+bool BasicWordChecker<SetType, TechniquePolicy>::lookUp(const std::string& candidate) const
+{
+    if constexpr(std::is_abstract<SetType>::value) {
+        return words.contains(candidate);
+    }
+    else {
+        return words.SetType::contains(candidate);
+    }
+}
+
+
+template <typename SetType, typename TechniquePolicy>
+bool BasicWordChecker<SetType, TechniquePolicy>::mayExist(std::string::size_type length) const noexcept
+{
+    if constexpr(HasShapes<SetType>::value) {
+        return words.hasLength(length);
+    }
+    else {
+        return true;
+    }
+}
+
+
+template <typename SetType, typename TechniquePolicy>
+bool BasicWordChecker<SetType, TechniquePolicy>::mayExist(std::string::size_type length, char first) const noexcept
+{
+    if constexpr(HasShapes<SetType>::value) {
+        return length == 0 ? words.hasLength(length) : words.hasShape(length, first);
+    }
+    else {
+        return true;
+    }
+}
+
+
+template <typename SetType, typename TechniquePolicy>
+template <typename Run>
+void BasicWordChecker<SetType, TechniquePolicy>::withHashes(const std::string& word, Run run) const
+{
+    if constexpr(MAY_BE_HASHED) {
+        if(hashed) {
+            PolynomialHash::Word hashes{word};
+            run(&hashes);
+            return;
+        }
+    }
+
+    run(static_cast<const PolynomialHash::Word*>(NULL));
+}
+
+
+template <typename SetType, typename TechniquePolicy>
+template <typename Probes, typename RawHash>
+bool BasicWordChecker<SetType, TechniquePolicy>::probe(
+    const std::string& candidate, Probes& probes, const PolynomialHash::Word* hashes, RawHash rawHash) const
+{
+    if(!probes.allow()) {
+        return false;
+    }
+
+    WORDCHECKER_STATS_PROBE();
+
+    if constexpr(MAY_BE_HASHED) {
+        if(hashes != NULL) {
+            return words.containsHashed(PolynomialHash::finish(rawHash()),
+                [&](const std::string& element) { return element == candidate; });
+        }
+    }
+
+    return lookUp(candidate);
+}
+
+
+template <typename SetType, typename TechniquePolicy>
+template <typename Probes, typename RawHash>
+void BasicWordChecker<SetType, TechniquePolicy>::probeLetters(
+    std::vector<std::string>& suggestions, std::string& candidate, std::string::size_type i,
+    Probes& probes, const PolynomialHash::Word* hashes, RawHash rawHash) const
+{
+    char letters[26];
+    unsigned int hashValues[26];
+    unsigned int count = 0;
+
+    for(char c = 'A'; c <= 'Z'; c++) {
+        // only at the front does the letter change the candidate's shape
+        if(i == 0 && !mayExist(candidate.size(), c)) {
+            continue;
+        }
+
+        if(!probes.allow()) {
+            break;
+        }
+
+        WORDCHECKER_STATS_PROBE();
+
+        if constexpr(MAY_BE_HASHED) {
+            if(hashes != NULL) {
+                hashValues[count] = PolynomialHash::finish(rawHash(c));
+            }
+        }
+
+        letters[count++] = c;
+    }
+
+    bool found[26];
+
+    if constexpr(MAY_BE_HASHED) {
+        if(hashes != NULL) {
+            // an element matches if it's the candidate with letters[k] at
+            // position i, which is checked without building the candidate
+            words.containsManyHashed(hashValues, count,
+                [&](unsigned int k, const std::string& element) {
+                    return element.size() == candidate.size()
+                        && element[i] == letters[k]
+                        && element.compare(0, i, candidate, 0, i) == 0
+                        && element.compare(i + 1, std::string::npos, candidate, i + 1, std::string::npos) == 0;
+                },
+                found);
+
+            for(unsigned int k = 0; k < count; k++) {
+                if(found[k]) {
+                    suggestions.push_back(candidate);
+                    suggestions.back()[i] = letters[k];
+                }
+            }
+            return;
+        }
+    }
+
+    if constexpr(HasContainsMany<SetType>::value) {
+        std::string candidates[26];
+
+        for(unsigned int k = 0; k < count; k++) {
+            candidates[k].assign(candidate);
+            candidates[k][i] = letters[k];
+        }
+
+        words.containsMany(candidates, count, found);
+        for(unsigned int k = 0; k < count; k++) {
+            if(found[k]) {
+                suggestions.push_back(std::move(candidates[k]));
+            }
+        }
+    }
+    else {
+        for(unsigned int k = 0; k < count; k++) {
+            candidate[i] = letters[k];
+            if(lookUp(candidate)) {
+                suggestions.push_back(candidate);
+            }
+        }
+    }
+}
+
+
+template <typename SetType, typename TechniquePolicy>
+template <typename Probes>
+void BasicWordChecker<SetType, TechniquePolicy>::findSwaps(
+    std::vector<std::string>& suggestions, const std::string& word, const PolynomialHash::Word* hashes, Probes& probes) const
+{
+    WORDCHECKER_STATS_SCOPE(1, word, suggestions);
+
+    std::string candidate = word;
+
+    for(std::string::size_type i = 0; i + 1 < word.size() && !probes.exhausted(); i++) {
+        // swapping the first pair changes the first letter
+        if(!mayExist(word.size(), i == 0 ? word[1] : word[0])) {
+            if(i == 0) {
+                continue;
+            }
+            break;
+        }
+
+        std::swap(candidate[i], candidate[i + 1]);
+        if(probe(candidate, probes, hashes, [&] { return hashes->swapped(i); })) {
+            suggestions.push_back(candidate);
+        }
+        std::swap(candidate[i], candidate[i + 1]);
+    }
+}
+
+
+template <typename SetType, typename TechniquePolicy>
+template <typename Probes>
+void BasicWordChecker<SetType, TechniquePolicy>::findInsertions(
+    std::vector<std::string>& suggestions, const std::string& word, const PolynomialHash::Word* hashes, Probes& probes) const
+{
+    WORDCHECKER_STATS_SCOPE(2, word, suggestions);
+
+    if(!mayExist(word.size() + 1)) {
+        return;
+    }
+
+    // "candidate" is the word with a gap at position i, which each letter
+    // fills in turn; moving the gap one place to the right only takes
+    // copying one letter of the word into the old gap
+    std::string candidate = ' ' + word;
+
+    for(std::string::size_type i = 0; i <= word.size() && !probes.exhausted(); i++) {
+        // past the first position, every candidate begins with word[0]
+        if(i > 0 && !mayExist(word.size() + 1, word[0])) {
+            break;
+        }
+
+        if(i > 0) {
+            candidate[i - 1] = word[i - 1];
+        }
+
+        probeLetters(suggestions, candidate, i, probes, hashes, [&](char c) { return hashes->inserted(i, c); });
+    }
+}
+
+
+template <typename SetType, typename TechniquePolicy>
+template <typename Probes>
+void BasicWordChecker<SetType, TechniquePolicy>::findDeletions(
+    std::vector<std::string>& suggestions, const std::string& word, const PolynomialHash::Word* hashes, Probes& probes) const
+{
+    WORDCHECKER_STATS_SCOPE(3, word, suggestions);
+
+    if(word.empty() || !mayExist(word.size() - 1)) {
+        return;
+    }
+
+    // "candidate" is the word without the letter at position i; moving on
+    // to the next position puts back the letter before it
+    std::string candidate = word.substr(1);
+
+    for(std::string::size_type i = 0; i < word.size() && !probes.exhausted(); i++) {
+        if(i > 0) {
+            candidate[i - 1] = word[i - 1];
+        }
+
+        // deleting the first letter makes word[1] the first letter
+        if(!mayExist(word.size() - 1, i == 0 ? word[1] : word[0])) {
+            if(i == 0) {
+                continue;
+            }
+            break;
+        }
+
+        if(probe(candidate, probes, hashes, [&] { return hashes->deleted(i); })) {
+            suggestions.push_back(candidate);
+        }
+    }
+}
+
+
+template <typename SetType, typename TechniquePolicy>
+template <typename Probes>
+void BasicWordChecker<SetType, TechniquePolicy>::findReplacements(
+    std::vector<std::string>& suggestions, const std::string& word, const PolynomialHash::Word* hashes, Probes& probes) const
+{
+    WORDCHECKER_STATS_SCOPE(4, word, suggestions);
+
+    if(!mayExist(word.size())) {
+        return;
+    }
+
+    std::string candidate = word;
+
+    for(std::string::size_type i = 0; i < word.size() && !probes.exhausted(); i++) {
+        // past the first position, every candidate begins with word[0]
+        if(i > 0 && !mayExist(word.size(), word[0])) {
+            break;
+        }
+
+        probeLetters(suggestions, candidate, i, probes, hashes, [&](char c) { return hashes->replaced(i, c); });
+        candidate[i] = word[i];
+    }
+}
+
+
+template <typename SetType, typename TechniquePolicy>
+template <typename Probes>
+void BasicWordChecker<SetType, TechniquePolicy>::findSplits(
+    std::vector<std::string>& suggestions, const std::string& word, const PolynomialHash::Word* hashes, Probes& probes) const
+{
+    WORDCHECKER_STATS_SCOPE(5, word, suggestions);
+
+    std::string left;
+    std::string right;
+
+    for(std::string::size_type i = 1; i < word.size() && !probes.exhausted(); i++) {
+        if(!mayExist(i, word[0]) || !mayExist(word.size() - i, word[i])) {
+            continue;
+        }
+
+        left.assign(word, 0, i);
+        right.assign(word, i, std::string::npos);
+
+        // the right half is only looked up if the left half is a word
+        if(probe(left, probes, hashes, [&] { return hashes->piece(0, i); })
+            && probe(right, probes, hashes, [&] { return hashes->piece(i, word.size()); })) {
+            suggestions.push_back(left + " " + right);
+        }
+    }
+}
+
+
+
+#endif // BASICWORDCHECKER_HPP
@@ -0,0 +1,426 @@
+// CheckingPipeline.cpp
+//
+// ICS 46 Spring 2018
+// Project #4: Set the Controls for the Heart of the Sun
+
+#include "CheckingPipeline.hpp"
+#include "RingBuffer.hpp"
+
+#include <cctype>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+
+
+namespace
+{
+    const char* const STAGE_NAMES[CheckingPipeline::STAGE_COUNT] = {
+        "read", "tokenize", "check", "suggest", "emit"
+    };
+
+
+    struct Document
+    {
+        std::size_t index = 0;
+        std::string text;
+    };
+
+
+    struct Token
+    {
+        std::size_t document;
+        std::string::size_type position;
+        std::string word;
+    };
+
+    using TokenBatch = std::vector<Token>;
+    using MisspellingBatch = std::vector<CheckingPipeline::Misspelling>;
+
+
+    // queueCapacity() returns the capacity that a RingBuffer asked for the
+    // given capacity ends up with.
+    unsigned int queueCapacity(unsigned int requested) noexcept
+    {
+        unsigned int capacity = 2;
+        while(capacity < requested) {
+            capacity *= 2;
+        }
+        return capacity;
+    }
+
+
+    std::int64_t now() noexcept
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+
+    bool isLetter(char c)
+    {
+        return std::isalpha(static_cast<unsigned char>(c)) != 0;
+    }
+
+
+    // A Shutdown stops a run early: the first exception thrown in any stage
+    // is kept to be rethrown by run(), and every queue is closed, so the
+    // threads waiting on them give up.
+    class Shutdown
+    {
+    public:
+        explicit Shutdown(std::function<void()> closeAll)
+            : closeAll{std::move(closeAll)}, failed{false}
+        {
+        }
+
+        void fail(std::exception_ptr exception)
+        {
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+                if(!first) {
+                    first = exception;
+                }
+            }
+
+            failed.store(true, std::memory_order_release);
+            closeAll();
+        }
+
+        bool hasFailed() const noexcept
+        {
+            return failed.load(std::memory_order_acquire);
+        }
+
+        void rethrow()
+        {
+            if(first) {
+                std::rethrow_exception(first);
+            }
+        }
+
+    private:
+        std::function<void()> closeAll;
+        std::atomic<bool> failed;
+        std::mutex mutex;
+        std::exception_ptr first;
+    };
+}
+
+
+
+void CheckingPipeline::StageCounters::reset() noexcept
+{
+    items.store(0, std::memory_order_relaxed);
+    busyNanoseconds.store(0, std::memory_order_relaxed);
+    depthTotal.store(0, std::memory_order_relaxed);
+    depthSamples.store(0, std::memory_order_relaxed);
+    depth.store(0, std::memory_order_relaxed);
+    maxDepth.store(0, std::memory_order_relaxed);
+}
+
+
+void CheckingPipeline::StageCounters::sample(unsigned int queueDepth) noexcept
+{
+    depth.store(queueDepth, std::memory_order_relaxed);
+    depthTotal.fetch_add(queueDepth, std::memory_order_relaxed);
+    depthSamples.fetch_add(1, std::memory_order_relaxed);
+
+    unsigned int deepest = maxDepth.load(std::memory_order_relaxed);
+    while(queueDepth > deepest && !maxDepth.compare_exchange_weak(deepest, queueDepth, std::memory_order_relaxed)) {
+    }
+}
+
+
+
+CheckingPipeline::CheckingPipeline(const WordChecker& checker)
+    : CheckingPipeline{checker, Options{}}
+{
+}
+
+
+CheckingPipeline::CheckingPipeline(const WordChecker& checker, Options options)
+    : checker{checker}, options{options}, startTime{0}, finishTime{0}
+{
+    if(this->options.checkWorkers == 0) {
+        this->options.checkWorkers = 1;
+    }
+    if(this->options.suggestWorkers == 0) {
+        this->options.suggestWorkers = 1;
+    }
+    if(this->options.batchSize == 0) {
+        this->options.batchSize = 1;
+    }
+}
+
+
+void CheckingPipeline::run(Source source, Emit emit)
+{
+    for(StageCounters& stage : counters) {
+        stage.reset();
+    }
+    finishTime.store(0, std::memory_order_relaxed);
+    startTime.store(now(), std::memory_order_relaxed);
+
+    RingBuffer<Document> documents{options.queueCapacity};
+    RingBuffer<TokenBatch> tokens{options.queueCapacity};
+    RingBuffer<TokenBatch> misspelled{options.queueCapacity};
+    RingBuffer<MisspellingBatch> results{options.queueCapacity};
+
+    Shutdown shutdown{[&] {
+        documents.close();
+        tokens.close();
+        misspelled.close();
+        results.close();
+    }};
+
+    // guarded() runs one worker, passing any exception it throws to the
+    // Shutdown, and closes the stage's output queue once the last of the
+    // stage's workers has finished
+    auto guarded = [&](std::atomic<unsigned int>& running, auto& output, auto work) {
+        std::atomic<unsigned int>* stillRunning = &running;
+        auto* queue = &output;
+        Shutdown* stop = &shutdown;
+
+        return [stillRunning, queue, stop, work] {
+            try {
+                work();
+            }
+            catch(...) {
+                stop->fail(std::current_exception());
+            }
+
+            if(stillRunning->fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                queue->close();
+            }
+        };
+    };
+
+    std::atomic<unsigned int> reading{1};
+    std::atomic<unsigned int> tokenizing{1};
+    std::atomic<unsigned int> checking{options.checkWorkers};
+    std::atomic<unsigned int> suggesting{options.suggestWorkers};
+
+    std::vector<std::thread> threads;
+    threads.reserve(2 + options.checkWorkers + options.suggestWorkers);
+
+    // start() runs a worker on a new thread.  If the thread can't be
+    // started, the pipeline is shut down as though a worker had thrown, so
+    // the threads already running are stopped and joined below -- rather
+    // than destroyed while joinable, which would terminate the program --
+    // before the exception is rethrown.
+    auto start = [&](auto worker) {
+        if(shutdown.hasFailed()) {
+            return;
+        }
+
+        try {
+            threads.emplace_back(std::move(worker));
+        }
+        catch(...) {
+            shutdown.fail(std::current_exception());
+        }
+    };
+
+    start(guarded(reading, documents, [&] {
+        StageCounters& stage = counters[READ];
+
+        for(std::size_t index = 0; !shutdown.hasFailed(); index++) {
+            Document document;
+            document.index = index;
+
+            std::int64_t start = now();
+            bool more = source(document.text);
+            stage.busyNanoseconds.fetch_add(now() - start, std::memory_order_relaxed);
+
+            if(!more || !documents.push(std::move(document))) {
+                break;
+            }
+
+            stage.items.fetch_add(1, std::memory_order_relaxed);
+        }
+    }));
+
+    start(guarded(tokenizing, tokens, [&] {
+        StageCounters& stage = counters[TOKENIZE];
+        Document document;
+        TokenBatch batch;
+
+        while(!shutdown.hasFailed() && documents.pop(document)) {
+            stage.sample(documents.depth());
+            std::int64_t start = now();
+            const std::string& text = document.text;
+
+            std::string::size_type i = 0;
+            while(i < text.size()) {
+                if(!isLetter(text[i])) {
+                    i++;
+                    continue;
+                }
+
+                std::string::size_type begin = i;
+                while(i < text.size() && isLetter(text[i])) {
+                    i++;
+                }
+
+                batch.push_back(Token{document.index, begin, text.substr(begin, i - begin)});
+                for(char& c : batch.back().word) {
+                    c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+                }
+
+                if(batch.size() == options.batchSize) {
+                    stage.items.fetch_add(batch.size(), std::memory_order_relaxed);
+                    stage.busyNanoseconds.fetch_add(now() - start, std::memory_order_relaxed);
+                    if(!tokens.push(std::move(batch))) {
+                        return;
+                    }
+                    batch = TokenBatch{};
+                    batch.reserve(options.batchSize);
+                    start = now();
+                }
+            }
+
+            stage.busyNanoseconds.fetch_add(now() - start, std::memory_order_relaxed);
+        }
+
+        if(!batch.empty()) {
+            stage.items.fetch_add(batch.size(), std::memory_order_relaxed);
+            tokens.push(std::move(batch));
+        }
+    }));
+
+    for(unsigned int w = 0; w < options.checkWorkers; w++) {
+        start(guarded(checking, misspelled, [&] {
+            StageCounters& stage = counters[CHECK];
+            TokenBatch batch;
+
+            while(!shutdown.hasFailed() && tokens.pop(batch)) {
+                stage.sample(tokens.depth());
+                std::int64_t start = now();
+
+                TokenBatch wrong;
+                for(Token& token : batch) {
+                    if(!checker.wordExists(token.word)) {
+                        wrong.push_back(std::move(token));
+                    }
+                }
+
+                stage.items.fetch_add(batch.size(), std::memory_order_relaxed);
+                stage.busyNanoseconds.fetch_add(now() - start, std::memory_order_relaxed);
+
+                if(!wrong.empty() && !misspelled.push(std::move(wrong))) {
+                    return;
+                }
+            }
+        }));
+    }
+
+    for(unsigned int w = 0; w < options.suggestWorkers; w++) {
+        start(guarded(suggesting, results, [&] {
+            StageCounters& stage = counters[SUGGEST];
+            TokenBatch batch;
+
+            while(!shutdown.hasFailed() && misspelled.pop(batch)) {
+                stage.sample(misspelled.depth());
+                std::int64_t start = now();
+
+                MisspellingBatch found;
+                found.reserve(batch.size());
+                for(Token& token : batch) {
+                    std::vector<std::string> suggestions = checker.findSuggestions(token.word);
+                    found.push_back(Misspelling{token.document, token.position, std::move(token.word), std::move(suggestions)});
+                }
+
+                stage.items.fetch_add(batch.size(), std::memory_order_relaxed);
+                stage.busyNanoseconds.fetch_add(now() - start, std::memory_order_relaxed);
+
+                if(!results.push(std::move(found))) {
+                    return;
+                }
+            }
+        }));
+    }
+
+    // the emit stage runs on this thread
+    try {
+        StageCounters& stage = counters[EMIT];
+        MisspellingBatch batch;
+
+        while(!shutdown.hasFailed() && results.pop(batch)) {
+            stage.sample(results.depth());
+            std::int64_t start = now();
+
+            for(Misspelling& misspelling : batch) {
+                emit(misspelling);
+            }
+
+            stage.items.fetch_add(batch.size(), std::memory_order_relaxed);
+            stage.busyNanoseconds.fetch_add(now() - start, std::memory_order_relaxed);
+        }
+    }
+    catch(...) {
+        shutdown.fail(std::current_exception());
+    }
+
+    for(std::thread& thread : threads) {
+        thread.join();
+    }
+
+    finishTime.store(now(), std::memory_order_relaxed);
+    shutdown.rethrow();
+}
+
+
+void CheckingPipeline::run(const std::vector<std::string>& paths, Emit emit)
+{
+    std::size_t next = 0;
+
+    run([&](std::string& document) {
+        if(next == paths.size()) {
+            return false;
+        }
+
+        std::ifstream file{paths[next++], std::ios::binary};
+        document.assign(std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{});
+        return true;
+    }, std::move(emit));
+}
+
+
+CheckingPipeline::Metrics CheckingPipeline::metrics() const
+{
+    Metrics metrics;
+
+    std::int64_t start = startTime.load(std::memory_order_relaxed);
+    std::int64_t finish = finishTime.load(std::memory_order_relaxed);
+    if(start == 0) {
+        metrics.elapsedNanoseconds = 0;
+    }
+    else {
+        metrics.elapsedNanoseconds = static_cast<std::uint64_t>((finish == 0 ? now() : finish) - start);
+    }
+
+    const unsigned int workers[STAGE_COUNT] = {1, 1, options.checkWorkers, options.suggestWorkers, 1};
+
+    for(unsigned int s = 0; s < STAGE_COUNT; s++) {
+        const StageCounters& stage = counters[s];
+        StageMetrics& m = metrics.stages[s];
+
+        std::uint64_t samples = stage.depthSamples.load(std::memory_order_relaxed);
+
+        m.name = STAGE_NAMES[s];
+        m.workers = workers[s];
+        m.items = stage.items.load(std::memory_order_relaxed);
+        m.busyNanoseconds = stage.busyNanoseconds.load(std::memory_order_relaxed);
+        m.queueCapacity = s == READ ? 0 : queueCapacity(options.queueCapacity);
+        m.queueDepth = stage.depth.load(std::memory_order_relaxed);
+        m.maxQueueDepth = stage.maxDepth.load(std::memory_order_relaxed);
+        m.averageQueueDepth = samples == 0 ? 0.0
+            : static_cast<double>(stage.depthTotal.load(std::memory_order_relaxed)) / samples;
+    }
+
+    return metrics;
+}
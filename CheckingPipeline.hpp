@@ -0,0 +1,178 @@
+// CheckingPipeline.hpp
+//
+// ICS 46 Spring 2018
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// A CheckingPipeline checks a whole corpus of documents with a WordChecker,
+// running the steps of the job as concurrent stages rather than one thread
+// doing each step in turn:
+//
+//     read -> tokenize -> check -> suggest -> emit
+//
+// "read" takes documents from a source (such as a list of files), and
+// "tokenize" splits them into tokens (maximal runs of letters, converted
+// to upper case, as a DocumentChecker does).  "check" calls wordExists()
+// on each token and passes along only the misspelled ones, and "suggest"
+// calls findSuggestions() on those.  Finally, "emit" hands each misspelling
+// to a function on the thread that called run().
+//
+// The stages are connected by RingBuffers, which hold batches of tokens
+// rather than single ones, so the cost of a push and a pop is spread over
+// many tokens.  Since the queues are bounded, a slow stage holds back the
+// ones feeding it, and the memory in flight is bounded by the capacities.
+// Finding suggestions costs about a hundred times what checking a word
+// does, so the check and suggest stages each have as many workers as the
+// Options ask for, independently of each other.
+//
+// Each stage keeps counters that metrics() reports, from any thread, while
+// a run is going on or after it has finished: how many items it has
+// processed, how long its workers have spent working (as opposed to
+// waiting on a queue), and how full the queue feeding it has been.
+//
+// You are permitted to use the C++ Standard Library in this class.
+
+#ifndef CHECKINGPIPELINE_HPP
+#define CHECKINGPIPELINE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "ParallelBuild.hpp"
+#include "WordChecker.hpp"
+
+
+
+class CheckingPipeline
+{
+public:
+    struct Options
+    {
+        // the number of threads running wordExists()
+        unsigned int checkWorkers = 1;
+
+        // the number of threads running findSuggestions()
+        unsigned int suggestWorkers = defaultThreadCount();
+
+        // the number of batches that each queue between stages can hold
+        unsigned int queueCapacity = 64;
+
+        // the number of tokens in each batch
+        unsigned int batchSize = 256;
+    };
+
+    // A Misspelling is one misspelled token: the document it's in (numbered
+    // in the order the source produced them, from 0), where it is, the
+    // token converted to upper case, and the suggestions for it.
+    struct Misspelling
+    {
+        std::size_t document;
+        std::string::size_type position;
+        std::string word;
+        std::vector<std::string> suggestions;
+    };
+
+    // A Source produces the documents to check: each call stores the next
+    // one in "document" and returns true, or returns false when there are
+    // no more.
+    using Source = std::function<bool(std::string& document)>;
+
+    // An Emit function receives each misspelling.  Misspellings arrive in no
+    // particular order, since the suggest stage's workers finish them in
+    // whatever order they do.
+    using Emit = std::function<void(Misspelling& misspelling)>;
+
+    enum Stage
+    {
+        READ,
+        TOKENIZE,
+        CHECK,
+        SUGGEST,
+        EMIT,
+        STAGE_COUNT
+    };
+
+    // StageMetrics describes one stage.  "items" counts documents for read,
+    // tokens for tokenize and check, and misspellings for suggest and emit.
+    // The queue figures are for the queue feeding the stage (read has none)
+    // and count batches; the depth is sampled each time a batch is taken.
+    struct StageMetrics
+    {
+        const char* name;
+        unsigned int workers;
+        std::uint64_t items;
+        std::uint64_t busyNanoseconds;
+        unsigned int queueCapacity;
+        unsigned int queueDepth;
+        unsigned int maxQueueDepth;
+        double averageQueueDepth;
+    };
+
+    struct Metrics
+    {
+        // the time since the current (or last) run started, or how long it
+        // took if it's finished
+        std::uint64_t elapsedNanoseconds;
+
+        StageMetrics stages[STAGE_COUNT];
+    };
+
+public:
+    // Initializes a CheckingPipeline that uses the given WordChecker, which
+    // must outlive it.
+    explicit CheckingPipeline(const WordChecker& checker);
+    CheckingPipeline(const WordChecker& checker, Options options);
+
+    CheckingPipeline(const CheckingPipeline& p) = delete;
+    CheckingPipeline& operator=(const CheckingPipeline& p) = delete;
+
+
+    // run() checks every document from the source, calling "emit" for each
+    // misspelled token, and returns once every stage has finished.  If the
+    // source or "emit" throws an exception, the pipeline is shut down and
+    // the exception is rethrown here.  Only one run may be going on at a
+    // time.
+    void run(Source source, Emit emit);
+
+
+    // This version of run() reads the documents from the files at the given
+    // paths, numbering them by their position in the vector.  A file that
+    // can't be read is checked as an empty document.
+    void run(const std::vector<std::string>& paths, Emit emit);
+
+
+    // metrics() returns the counters of every stage.  It can be called from
+    // any thread at any time.
+    Metrics metrics() const;
+
+
+private:
+    struct StageCounters
+    {
+        std::atomic<std::uint64_t> items{0};
+        std::atomic<std::uint64_t> busyNanoseconds{0};
+        std::atomic<std::uint64_t> depthTotal{0};
+        std::atomic<std::uint64_t> depthSamples{0};
+        std::atomic<unsigned int> depth{0};
+        std::atomic<unsigned int> maxDepth{0};
+
+        void reset() noexcept;
+
+        // sample() records the depth of the queue feeding the stage.
+        void sample(unsigned int queueDepth) noexcept;
+    };
+
+    const WordChecker& checker;
+    Options options;
+
+    StageCounters counters[STAGE_COUNT];
+    std::atomic<std::int64_t> startTime;
+    std::atomic<std::int64_t> finishTime;
+};
+
+
+
+#endif // CHECKINGPIPELINE_HPP
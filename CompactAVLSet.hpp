@@ -0,0 +1,595 @@
+// CompactAVLSet.hpp
+//
+// ICS 46 Spring 2018
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// A CompactAVLSet is an AVL tree with the same interface and behavior as an
+// AVLSet, but a different way of storing its nodes.  Rather than allocating
+// each node separately and linking them with pointers, it keeps every node
+// in one dynamically-allocated array (an "arena"), which doubles in size
+// when it fills, and links them by 32-bit offsets into the arena.  The
+// heights, which only add() needs, are kept in a separate array of bytes,
+// so a node is its element plus eight bytes, where an AVLSet's TreeNode
+// is its element plus three pointers and a height.  The nodes are also
+// next to each other in memory, in the order they were added, so a lookup
+// touches fewer cache lines and pages.
+//
+// A link is the node's offset in bytes from the start of the arena, rather
+// than its index, so that following one is a single addition (as following
+// a pointer would be) instead of a multiplication and an addition.  Index 0
+// is never used for a node, so that offset 0 can mean "no child".  There
+// can be up to MAX_SIZE elements.
+//
+// As with the AVLSet, the balancing can be turned off by passing false to
+// the constructor.
+
+#ifndef COMPACTAVLSET_HPP
+#define COMPACTAVLSET_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include "Set.hpp"
+
+
+
+template <typename ElementType>
+class CompactAVLSet : public Set<ElementType>
+{
+private:
+    struct Node
+    {
+        ElementType element;
+
+        // links[0] is the left child and links[1] the right one
+        std::uint32_t links[2];
+    };
+
+public:
+    // A VisitFunction is a function that takes a reference to a const
+    // ElementType and returns no value.
+    using VisitFunction = std::function<void(const ElementType&)>;
+
+    // The most elements that a CompactAVLSet can hold, which is as many as
+    // 32-bit offsets can reach.
+    static constexpr unsigned int MAX_SIZE = static_cast<unsigned int>(0xFFFFFFFFu / sizeof(Node) - 1);
+
+public:
+    // Initializes a CompactAVLSet to be empty, with or without balancing.
+    explicit CompactAVLSet(bool shouldBalance = true);
+
+    // Cleans up the CompactAVLSet so that it leaks no memory.
+    virtual ~CompactAVLSet() noexcept;
+
+    // Initializes a new CompactAVLSet to be a copy of an existing one.
+    CompactAVLSet(const CompactAVLSet& s);
+
+    // Initializes a new CompactAVLSet whose contents are moved from an
+    // expiring one.
+    CompactAVLSet(CompactAVLSet&& s) noexcept;
+
+    // Assigns an existing CompactAVLSet into another.
+    CompactAVLSet& operator=(const CompactAVLSet& s);
+
+    // Assigns an expiring CompactAVLSet into another.
+    CompactAVLSet& operator=(CompactAVLSet&& s) noexcept;
+
+
+    // isImplemented() returns true, since a CompactAVLSet is implemented.
+    virtual bool isImplemented() const noexcept override;
+
+
+    // add() adds an element to the set.  If the element is already in the
+    // set, this function has no effect.  This function runs in O(log n) time
+    // when there are n elements in the tree, except when the arena has to
+    // grow, which takes O(n) time but happens only when the size doubles.
+    // It throws a std::length_error if the set already has MAX_SIZE elements.
+    virtual void add(const ElementType& element) override;
+
+
+    // contains() returns true if the given element is already in the set,
+    // false otherwise.  This function always runs in O(log n) time when
+    // there are n elements in the tree.
+    virtual bool contains(const ElementType& element) const override;
+
+
+    // size() returns the number of elements in the set.
+    virtual unsigned int size() const noexcept override;
+
+
+    // height() returns the height of the AVL tree.  Note that, by definition,
+    // the height of an empty tree is -1.
+    int height() const;
+
+
+    // preorder(), inorder() and postorder() call the given "visit" function
+    // for each of the elements in the set, in the order determined by the
+    // corresponding traversal of the AVL tree.
+    void preorder(VisitFunction visit) const;
+    void inorder(VisitFunction visit) const;
+    void postorder(VisitFunction visit) const;
+
+
+    // memoryUsage() returns the number of bytes in the arena and the array
+    // of heights, not counting anything that the elements allocate
+    // themselves.
+    std::size_t memoryUsage() const noexcept;
+
+
+private:
+    static constexpr std::uint32_t NONE = 0;
+
+    bool shouldBalance;
+
+    // nodes[1] through nodes[count] are in use; heights[i] is the height of
+    // nodes[i], and heights is NULL when the tree isn't balanced, since
+    // only balancing needs them
+    Node* nodes;
+    signed char* heights;
+    std::uint32_t count;
+    std::uint32_t capacity;
+    std::uint32_t root;
+
+    // at() follows a link to its node
+    Node& at(std::uint32_t link) noexcept;
+    const Node& at(std::uint32_t link) const noexcept;
+
+    static std::uint32_t linkTo(std::uint32_t index) noexcept;
+    static std::uint32_t indexOf(std::uint32_t link) noexcept;
+
+    // the height of a node, or -1 for NONE
+    int nodeHeight(std::uint32_t node) const noexcept;
+    void updateHeight(std::uint32_t node) noexcept;
+
+    // returns a link to a new node holding the element, growing the arena
+    // if it's full
+    std::uint32_t allocate(const ElementType& element);
+
+    // adds the element to the subtree rooted at "node", setting "added" if
+    // it wasn't already there, and returns the subtree's new root
+    std::uint32_t insert(std::uint32_t node, const ElementType& element, bool& added);
+
+    std::uint32_t rotateLeft(std::uint32_t node) noexcept;
+    std::uint32_t rotateRight(std::uint32_t node) noexcept;
+    std::uint32_t balance(std::uint32_t node) noexcept;
+    int balanceFactor(std::uint32_t node) const noexcept;
+
+    int recursiveHeight(std::uint32_t node) const;
+
+    void recursivePreorder(VisitFunction& visit, std::uint32_t node) const;
+    void recursiveInorder(VisitFunction& visit, std::uint32_t node) const;
+    void recursivePostorder(VisitFunction& visit, std::uint32_t node) const;
+
+    void copyFrom(const CompactAVLSet& s);
+};
+
+
+
+template <typename ElementType>
+CompactAVLSet<ElementType>::CompactAVLSet(bool shouldBalance)
+    : shouldBalance{shouldBalance}, nodes{NULL}, heights{NULL}, count{0}, capacity{0}, root{NONE}
+{
+}
+
+
+template <typename ElementType>
+CompactAVLSet<ElementType>::~CompactAVLSet() noexcept
+{
+    delete[] nodes;
+    delete[] heights;
+}
+
+
+template <typename ElementType>
+CompactAVLSet<ElementType>::CompactAVLSet(const CompactAVLSet& s)
+    : shouldBalance{s.shouldBalance}, nodes{NULL}, heights{NULL}, count{0}, capacity{0}, root{NONE}
+{
+    copyFrom(s);
+}
+
+
+template <typename ElementType>
+CompactAVLSet<ElementType>::CompactAVLSet(CompactAVLSet&& s) noexcept
+    : shouldBalance{s.shouldBalance}, nodes{s.nodes}, heights{s.heights},
+      count{s.count}, capacity{s.capacity}, root{s.root}
+{
+    s.nodes = NULL;
+    s.heights = NULL;
+    s.count = 0;
+    s.capacity = 0;
+    s.root = NONE;
+}
+
+
+template <typename ElementType>
+CompactAVLSet<ElementType>& CompactAVLSet<ElementType>::operator=(const CompactAVLSet& s)
+{
+    if(this != &s) {
+        delete[] nodes;
+        delete[] heights;
+        nodes = NULL;
+        heights = NULL;
+        count = 0;
+        capacity = 0;
+        root = NONE;
+
+        shouldBalance = s.shouldBalance;
+        copyFrom(s);
+    }
+    return *this;
+}
+
+
+template <typename ElementType>
+CompactAVLSet<ElementType>& CompactAVLSet<ElementType>::operator=(CompactAVLSet&& s) noexcept
+{
+    std::swap(shouldBalance, s.shouldBalance);
+    std::swap(nodes, s.nodes);
+    std::swap(heights, s.heights);
+    std::swap(count, s.count);
+    std::swap(capacity, s.capacity);
+    std::swap(root, s.root);
+    return *this;
+}
+
+
+template <typename ElementType>
+bool CompactAVLSet<ElementType>::isImplemented() const noexcept
+{
+    return true;
+}
+
+
+template <typename ElementType>
+void CompactAVLSet<ElementType>::add(const ElementType& element)
+{
+    bool added = false;
+    root = insert(root, element, added);
+}
+
+
+template <typename ElementType>
+bool CompactAVLSet<ElementType>::contains(const ElementType& element) const
+{
+    std::uint32_t node = root;
+    while(node != NONE) {
+        const Node& here = at(node);
+        if(here.element == element) {
+            return true;
+        }
+
+        // both links are read as one 64-bit value and the child is chosen
+        // by shifting it, rather than by a branch, since which way a search
+        // goes is as good as random and a branch would be mispredicted about
+        // half the time.  That puts links[0] in the low half only on a
+        // little-endian machine; elsewhere, the links are indexed instead.
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        std::uint64_t links;
+        std::memcpy(&links, here.links, sizeof(links));
+        node = static_cast<std::uint32_t>(links >> (32 * (here.element < element)));
+#else
+        node = here.links[here.element < element];
+#endif
+    }
+    return false;
+}
+
+
+template <typename ElementType>
+unsigned int CompactAVLSet<ElementType>::size() const noexcept
+{
+    return count;
+}
+
+
+template <typename ElementType>
+int CompactAVLSet<ElementType>::height() const
+{
+    if(shouldBalance) {
+        return nodeHeight(root);
+    }
+    return recursiveHeight(root);
+}
+
+
+template <typename ElementType>
+void CompactAVLSet<ElementType>::preorder(VisitFunction visit) const
+{
+    recursivePreorder(visit, root);
+}
+
+
+template <typename ElementType>
+void CompactAVLSet<ElementType>::inorder(VisitFunction visit) const
+{
+    recursiveInorder(visit, root);
+}
+
+
+template <typename ElementType>
+void CompactAVLSet<ElementType>::postorder(VisitFunction visit) const
+{
+    recursivePostorder(visit, root);
+}
+
+
+template <typename ElementType>
+std::size_t CompactAVLSet<ElementType>::memoryUsage() const noexcept
+{
+    std::size_t bytes = static_cast<std::size_t>(capacity) * sizeof(Node);
+    if(heights != NULL) {
+        bytes += capacity;
+    }
+    return bytes;
+}
+
+
+template <typename ElementType>
+typename CompactAVLSet<ElementType>::Node& CompactAVLSet<ElementType>::at(std::uint32_t link) noexcept
+{
+    return *reinterpret_cast<Node*>(reinterpret_cast<char*>(nodes) + link);
+}
+
+
+template <typename ElementType>
+const typename CompactAVLSet<ElementType>::Node& CompactAVLSet<ElementType>::at(std::uint32_t link) const noexcept
+{
+    return *reinterpret_cast<const Node*>(reinterpret_cast<const char*>(nodes) + link);
+}
+
+
+template <typename ElementType>
+std::uint32_t CompactAVLSet<ElementType>::linkTo(std::uint32_t index) noexcept
+{
+    return index * static_cast<std::uint32_t>(sizeof(Node));
+}
+
+
+template <typename ElementType>
+std::uint32_t CompactAVLSet<ElementType>::indexOf(std::uint32_t link) noexcept
+{
+    return link / static_cast<std::uint32_t>(sizeof(Node));
+}
+
+
+template <typename ElementType>
+int CompactAVLSet<ElementType>::nodeHeight(std::uint32_t node) const noexcept
+{
+    if(node == NONE) {
+        return -1;
+    }
+    return heights[indexOf(node)];
+}
+
+
+template <typename ElementType>
+void CompactAVLSet<ElementType>::updateHeight(std::uint32_t node) noexcept
+{
+    int leftHeight = nodeHeight(at(node).links[0]);
+    int rightHeight = nodeHeight(at(node).links[1]);
+    heights[indexOf(node)] = static_cast<signed char>((leftHeight > rightHeight ? leftHeight : rightHeight) + 1);
+}
+
+
+template <typename ElementType>
+std::uint32_t CompactAVLSet<ElementType>::allocate(const ElementType& element)
+{
+    if(count >= MAX_SIZE) {
+        throw std::length_error{"CompactAVLSet is full"};
+    }
+
+    if(count + 1 >= capacity) {
+        std::uint32_t newCapacity = capacity == 0 ? 16 : capacity * 2;
+        if(newCapacity > MAX_SIZE + 1 || newCapacity < capacity) {
+            newCapacity = MAX_SIZE + 1;
+        }
+
+        Node* newNodes = new Node[newCapacity];
+        signed char* newHeights = NULL;
+        try {
+            if(shouldBalance) {
+                newHeights = new signed char[newCapacity];
+            }
+            for(std::uint32_t i = 1; i <= count; i++) {
+                newNodes[i] = std::move(nodes[i]);
+                if(shouldBalance) {
+                    newHeights[i] = heights[i];
+                }
+            }
+        }
+        catch(...) {
+            delete[] newNodes;
+            delete[] newHeights;
+            throw;
+        }
+
+        delete[] nodes;
+        delete[] heights;
+        nodes = newNodes;
+        heights = newHeights;
+        capacity = newCapacity;
+    }
+
+    nodes[count + 1].element = element;
+    count++;
+
+    nodes[count].links[0] = NONE;
+    nodes[count].links[1] = NONE;
+    if(shouldBalance) {
+        heights[count] = 0;
+    }
+    return linkTo(count);
+}
+
+
+template <typename ElementType>
+std::uint32_t CompactAVLSet<ElementType>::insert(std::uint32_t node, const ElementType& element, bool& added)
+{
+    if(node == NONE) {
+        added = true;
+        return allocate(element);
+    }
+
+    // allocate() may move the arena, so no reference to a node is held
+    // across the recursive calls (the links themselves stay valid)
+    if(element < at(node).element) {
+        std::uint32_t child = insert(at(node).links[0], element, added);
+        at(node).links[0] = child;
+    }
+    else if(at(node).element < element) {
+        std::uint32_t child = insert(at(node).links[1], element, added);
+        at(node).links[1] = child;
+    }
+    else {
+        return node;
+    }
+
+    if(!added || !shouldBalance) {
+        return node;
+    }
+
+    updateHeight(node);
+    return balance(node);
+}
+
+
+template <typename ElementType>
+std::uint32_t CompactAVLSet<ElementType>::rotateLeft(std::uint32_t node) noexcept
+{
+    std::uint32_t newRoot = at(node).links[1];
+    at(node).links[1] = at(newRoot).links[0];
+    at(newRoot).links[0] = node;
+    updateHeight(node);
+    updateHeight(newRoot);
+    return newRoot;
+}
+
+
+template <typename ElementType>
+std::uint32_t CompactAVLSet<ElementType>::rotateRight(std::uint32_t node) noexcept
+{
+    std::uint32_t newRoot = at(node).links[0];
+    at(node).links[0] = at(newRoot).links[1];
+    at(newRoot).links[1] = node;
+    updateHeight(node);
+    updateHeight(newRoot);
+    return newRoot;
+}
+
+
+template <typename ElementType>
+std::uint32_t CompactAVLSet<ElementType>::balance(std::uint32_t node) noexcept
+{
+    int factor = balanceFactor(node);
+
+    if(factor > 1) {
+        if(balanceFactor(at(node).links[0]) < 0) {
+            at(node).links[0] = rotateLeft(at(node).links[0]);
+        }
+        return rotateRight(node);
+    }
+    else if(factor < -1) {
+        if(balanceFactor(at(node).links[1]) > 0) {
+            at(node).links[1] = rotateRight(at(node).links[1]);
+        }
+        return rotateLeft(node);
+    }
+
+    return node;
+}
+
+
+template <typename ElementType>
+int CompactAVLSet<ElementType>::balanceFactor(std::uint32_t node) const noexcept
+{
+    return nodeHeight(at(node).links[0]) - nodeHeight(at(node).links[1]);
+}
+
+
+template <typename ElementType>
+int CompactAVLSet<ElementType>::recursiveHeight(std::uint32_t node) const
+{
+    if(node == NONE) {
+        return -1;
+    }
+
+    int leftHeight = recursiveHeight(at(node).links[0]);
+    int rightHeight = recursiveHeight(at(node).links[1]);
+    return (leftHeight > rightHeight ? leftHeight : rightHeight) + 1;
+}
+
+
+template <typename ElementType>
+void CompactAVLSet<ElementType>::recursivePreorder(VisitFunction& visit, std::uint32_t node) const
+{
+    if(node != NONE) {
+        visit(at(node).element);
+        recursivePreorder(visit, at(node).links[0]);
+        recursivePreorder(visit, at(node).links[1]);
+    }
+}
+
+
+template <typename ElementType>
+void CompactAVLSet<ElementType>::recursiveInorder(VisitFunction& visit, std::uint32_t node) const
+{
+    if(node != NONE) {
+        recursiveInorder(visit, at(node).links[0]);
+        visit(at(node).element);
+        recursiveInorder(visit, at(node).links[1]);
+    }
+}
+
+
+template <typename ElementType>
+void CompactAVLSet<ElementType>::recursivePostorder(VisitFunction& visit, std::uint32_t node) const
+{
+    if(node != NONE) {
+        recursivePostorder(visit, at(node).links[0]);
+        recursivePostorder(visit, at(node).links[1]);
+        visit(at(node).element);
+    }
+}
+
+
+template <typename ElementType>
+void CompactAVLSet<ElementType>::copyFrom(const CompactAVLSet& s)
+{
+    // the links are offsets, so they stay valid and the arena is copied
+    // as it is
+    if(s.count == 0) {
+        return;
+    }
+
+    Node* newNodes = new Node[s.capacity];
+    signed char* newHeights = NULL;
+    try {
+        if(s.heights != NULL) {
+            newHeights = new signed char[s.capacity];
+        }
+        for(std::uint32_t i = 1; i <= s.count; i++) {
+            newNodes[i] = s.nodes[i];
+            if(newHeights != NULL) {
+                newHeights[i] = s.heights[i];
+            }
+        }
+    }
+    catch(...) {
+        delete[] newNodes;
+        delete[] newHeights;
+        throw;
+    }
+
+    nodes = newNodes;
+    heights = newHeights;
+    capacity = s.capacity;
+    count = s.count;
+    root = s.root;
+}
+
+
+
+#endif // COMPACTAVLSET_HPP
@@ -0,0 +1,68 @@
+// CompactKey.cpp
+//
+// ICS 46 Spring 2018
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// The shared pool of long words used by CompactKey.
+
+#include "CompactKey.hpp"
+
+#include <mutex>
+#include <unordered_set>
+
+
+
+namespace
+{
+    // The pool never removes a word, and the nodes of an unordered_set never
+    // move, so a pointer to a pooled word's characters stays valid for the
+    // rest of the program.  Every word in the pool is longer than what fits
+    // inline, so its characters are always in their own heap buffer.
+    struct Pool
+    {
+        std::mutex mutex;
+        std::unordered_set<std::string> words;
+        std::size_t characterBytes = 0;
+    };
+
+
+    Pool& pool()
+    {
+        static Pool instance;
+        return instance;
+    }
+}
+
+
+
+const char* CompactKeyPool::intern(const std::string& word)
+{
+    Pool& p = pool();
+    std::lock_guard<std::mutex> lock{p.mutex};
+
+    auto result = p.words.insert(word);
+    if(result.second) {
+        p.characterBytes += word.capacity() + 1;
+    }
+
+    return result.first->data();
+}
+
+
+std::size_t CompactKeyPool::bytesUsed()
+{
+    Pool& p = pool();
+    std::lock_guard<std::mutex> lock{p.mutex};
+
+    // each entry is a node holding a std::string and a next pointer, plus
+    // a slot in the bucket array
+    return p.characterBytes
+        + p.words.size() * (sizeof(std::string) + sizeof(void*))
+        + p.words.bucket_count() * sizeof(void*);
+}
+
+
+unsigned int hashCompactKey(const CompactKey& key)
+{
+    return key.hash();
+}
@@ -0,0 +1,380 @@
+// CompactKey.hpp
+//
+// ICS 46 Spring 2018
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// A CompactKey is a 16-byte stand-in for a std::string, meant to be stored
+// in a Set in place of the string itself.  Words of up to 15 characters --
+// which is nearly all of the words in a dictionary -- are stored inline,
+// with the length in the last byte and the unused bytes zeroed, so a key
+// never owns a separate buffer.  Longer words are "interned": their
+// characters are stored once in a pool shared by every CompactKey, and the
+// key holds a pointer into the pool along with the word's length.
+//
+// Equal short words always produce byte-for-byte equal keys, so checking
+// two of them for equality is a single 16-byte comparison, and ordering
+// them only requires finding the first byte where they differ.  Both use
+// SSE2 when it's available.  Long words are compared by their characters,
+// not by where they're stored, so a key that's only used to look a word up
+// can point at the caller's string and never touch the pool.
+//
+// CompactKeySet adapts a Set of CompactKeys (such as a HashSet or AVLSet)
+// into a Set of std::strings, converting at the boundary, so that it can
+// be handed to a WordChecker.
+
+#ifndef COMPACTKEY_HPP
+#define COMPACTKEY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include "Set.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+
+
+class CompactKey
+{
+public:
+    // The longest word that is stored inline.
+    static constexpr unsigned int INLINE_CAPACITY = 15;
+
+public:
+    // Initializes a CompactKey representing the empty string.
+    CompactKey() noexcept;
+
+    // Initializes a CompactKey representing the given word, interning the
+    // word in the shared pool if it's too long to be stored inline.
+    explicit CompactKey(const std::string& word);
+
+    // forLookup() returns a CompactKey suitable only for looking the word up
+    // in a set.  A long word's key refers to the given string (which must
+    // outlive it) rather than to the pool, so looking a word up never locks
+    // the pool or adds to it.
+    static CompactKey forLookup(const std::string& word) noexcept;
+
+
+    // length() returns the number of characters in the word.
+    unsigned int length() const noexcept;
+
+    // data() returns a pointer to the word's characters, which are not
+    // necessarily followed by a null character.
+    const char* data() const noexcept;
+
+    // isInline() returns true if the word is stored in the key itself.
+    bool isInline() const noexcept;
+
+    // toString() returns the word as a std::string.
+    std::string toString() const;
+
+    // hash() returns a hash of the key.  A long word is hashed by its
+    // characters, so its pooled key and its lookup key hash alike.
+    unsigned int hash() const noexcept;
+
+
+    bool operator==(const CompactKey& other) const noexcept;
+    bool operator!=(const CompactKey& other) const noexcept;
+    bool operator<(const CompactKey& other) const noexcept;
+    bool operator>(const CompactKey& other) const noexcept;
+
+
+private:
+    // Inline:  bytes[0] through bytes[14] hold the characters, padded with
+    //          zeroes, and bytes[15] holds the length.
+    // Pooled:  bytes[0] through bytes[7] hold a pointer to the characters,
+    //          bytes[8] through bytes[11] hold the length, and bytes[15]
+    //          holds POOLED_MARKER.
+    alignas(16) unsigned char bytes[16];
+
+    static constexpr unsigned char POOLED_MARKER = 0xFF;
+
+    void setPooled(const char* characters, std::uint32_t length) noexcept;
+    void setInline(const char* characters, std::size_t length) noexcept;
+};
+
+
+
+// CompactKeyPool is the pool in which the characters of long words are
+// interned.  It's shared by every CompactKey and is safe to use from
+// multiple threads.
+
+class CompactKeyPool
+{
+public:
+    // intern() returns the pooled copy of the given word, adding it to the
+    // pool if it's not already there.  The returned pointer stays valid for
+    // the rest of the program.
+    static const char* intern(const std::string& word);
+
+    // bytesUsed() returns an estimate of the memory held by the pool.
+    static std::size_t bytesUsed();
+};
+
+
+// hashCompactKey() can be passed to a HashSet<CompactKey> as its hash
+// function.
+unsigned int hashCompactKey(const CompactKey& key);
+
+
+
+inline CompactKey::CompactKey() noexcept
+{
+    std::memset(bytes, 0, sizeof(bytes));
+}
+
+
+inline CompactKey::CompactKey(const std::string& word)
+{
+    if(word.size() <= INLINE_CAPACITY) {
+        setInline(word.data(), word.size());
+    }
+    else {
+        setPooled(CompactKeyPool::intern(word), static_cast<std::uint32_t>(word.size()));
+    }
+}
+
+
+inline CompactKey CompactKey::forLookup(const std::string& word) noexcept
+{
+    CompactKey key;
+
+    if(word.size() <= INLINE_CAPACITY) {
+        key.setInline(word.data(), word.size());
+    }
+    else {
+        key.setPooled(word.data(), static_cast<std::uint32_t>(word.size()));
+    }
+
+    return key;
+}
+
+
+inline unsigned int CompactKey::length() const noexcept
+{
+    if(isInline()) {
+        return bytes[15];
+    }
+
+    std::uint32_t length;
+    std::memcpy(&length, bytes + 8, sizeof(length));
+    return length;
+}
+
+
+inline const char* CompactKey::data() const noexcept
+{
+    if(isInline()) {
+        return reinterpret_cast<const char*>(bytes);
+    }
+
+    const char* characters;
+    std::memcpy(&characters, bytes, sizeof(characters));
+    return characters;
+}
+
+
+inline bool CompactKey::isInline() const noexcept
+{
+    return bytes[15] != POOLED_MARKER;
+}
+
+
+inline std::string CompactKey::toString() const
+{
+    return std::string(data(), length());
+}
+
+
+inline unsigned int CompactKey::hash() const noexcept
+{
+    if(!isInline()) {
+        // FNV-1a over the characters
+        const char* characters = data();
+        unsigned int length = this->length();
+
+        std::uint64_t h = 0xCBF29CE484222325ULL;
+        for(unsigned int i = 0; i < length; i++) {
+            h = (h ^ static_cast<unsigned char>(characters[i])) * 0x100000001B3ULL;
+        }
+        return static_cast<unsigned int>(h ^ (h >> 32));
+    }
+
+    std::uint64_t low;
+    std::uint64_t high;
+    std::memcpy(&low, bytes, sizeof(low));
+    std::memcpy(&high, bytes + 8, sizeof(high));
+
+    std::uint64_t h = (low ^ (high * 0x9E3779B97F4A7C15ULL)) * 0xC2B2AE3D27D4EB4FULL;
+    return static_cast<unsigned int>(h ^ (h >> 32));
+}
+
+
+inline bool CompactKey::operator==(const CompactKey& other) const noexcept
+{
+#if defined(__SSE2__)
+    __m128i a = _mm_load_si128(reinterpret_cast<const __m128i*>(bytes));
+    __m128i b = _mm_load_si128(reinterpret_cast<const __m128i*>(other.bytes));
+    bool identical = _mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) == 0xFFFF;
+#else
+    bool identical = std::memcmp(bytes, other.bytes, sizeof(bytes)) == 0;
+#endif
+
+    if(identical) {
+        return true;
+    }
+
+    // an inline word is never equal to a long one, but two long words can
+    // be equal while stored in different places
+    if(isInline() || other.isInline()) {
+        return false;
+    }
+
+    unsigned int length = this->length();
+    return length == other.length() && std::memcmp(data(), other.data(), length) == 0;
+}
+
+
+inline bool CompactKey::operator!=(const CompactKey& other) const noexcept
+{
+    return !(*this == other);
+}
+
+
+inline bool CompactKey::operator<(const CompactKey& other) const noexcept
+{
+    if(isInline() && other.isInline()) {
+        // the first differing byte decides; if it's the last byte, the
+        // characters all match and the shorter word comes first, which is
+        // exactly what comparing the lengths stored there gives us
+#if defined(__SSE2__)
+        __m128i a = _mm_load_si128(reinterpret_cast<const __m128i*>(bytes));
+        __m128i b = _mm_load_si128(reinterpret_cast<const __m128i*>(other.bytes));
+        unsigned int differences = ~static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(a, b))) & 0xFFFF;
+
+        if(differences == 0) {
+            return false;
+        }
+
+        unsigned int first = __builtin_ctz(differences);
+        return bytes[first] < other.bytes[first];
+#else
+        return std::memcmp(bytes, other.bytes, sizeof(bytes)) < 0;
+#endif
+    }
+
+    unsigned int length = this->length();
+    unsigned int otherLength = other.length();
+    int order = std::memcmp(data(), other.data(), length < otherLength ? length : otherLength);
+
+    return order < 0 || (order == 0 && length < otherLength);
+}
+
+
+inline bool CompactKey::operator>(const CompactKey& other) const noexcept
+{
+    return other < *this;
+}
+
+
+inline void CompactKey::setPooled(const char* characters, std::uint32_t length) noexcept
+{
+    std::memset(bytes, 0, sizeof(bytes));
+    std::memcpy(bytes, &characters, sizeof(characters));
+    std::memcpy(bytes + 8, &length, sizeof(length));
+    bytes[15] = POOLED_MARKER;
+}
+
+
+inline void CompactKey::setInline(const char* characters, std::size_t length) noexcept
+{
+    std::memset(bytes, 0, sizeof(bytes));
+    std::memcpy(bytes, characters, length);
+    bytes[15] = static_cast<unsigned char>(length);
+}
+
+
+
+template <typename KeySet>
+class CompactKeySet : public Set<std::string>
+{
+public:
+    // Initializes a CompactKeySet whose keys are stored in a KeySet
+    // constructed from the given arguments (e.g., a hash function, when
+    // KeySet is a HashSet<CompactKey>).
+    template <typename... Args>
+    explicit CompactKeySet(Args&&... args);
+
+    virtual bool isImplemented() const noexcept override;
+
+    // add() adds a word to the set.  If the word is already in the set,
+    // this function has no effect.
+    virtual void add(const std::string& word) override;
+
+    // contains() returns true if the given word is in the set, false
+    // otherwise.  No memory is allocated to look a word up.
+    virtual bool contains(const std::string& word) const override;
+
+    // size() returns the number of words in the set.
+    virtual unsigned int size() const noexcept override;
+
+    // keySet() returns the underlying set of keys.
+    const KeySet& keySet() const noexcept;
+
+private:
+    KeySet keys;
+};
+
+
+
+template <typename KeySet>
+template <typename... Args>
+CompactKeySet<KeySet>::CompactKeySet(Args&&... args)
+    : keys(std::forward<Args>(args)...)
+{
+}
+
+
+template <typename KeySet>
+bool CompactKeySet<KeySet>::isImplemented() const noexcept
+{
+    return keys.isImplemented();
+}
+
+
+template <typename KeySet>
+void CompactKeySet<KeySet>::add(const std::string& word)
+{
+    if(!contains(word)) {
+        keys.add(CompactKey{word});
+    }
+}
+
+
+template <typename KeySet>
+bool CompactKeySet<KeySet>::contains(const std::string& word) const
+{
+    return keys.contains(CompactKey::forLookup(word));
+}
+
+
+template <typename KeySet>
+unsigned int CompactKeySet<KeySet>::size() const noexcept
+{
+    return keys.size();
+}
+
+
+template <typename KeySet>
+const KeySet& CompactKeySet<KeySet>::keySet() const noexcept
+{
+    return keys;
+}
+
+
+
+#endif // COMPACTKEY_HPP
@@ -0,0 +1,319 @@
+// ConcurrentHashSet.hpp
+//
+// ICS 46 Spring 2018
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// A ConcurrentHashSet is a separately-chained hash table, like HashSet,
+// that can be used by many threads at once: any number of threads can call
+// contains() while others call add(), including an add() that resizes the
+// table.
+//
+// Readers never lock and never wait.  A node is fully built before it's
+// linked into its chain, and it's never changed once it's there, so a
+// reader only has to load the current table, load the head of a chain, and
+// follow the chain.  Each bucket's head is an atomic pointer, and new nodes
+// are published at the head with a release store.
+//
+// Writers lock one of STRIPE_COUNT mutexes, chosen by the element's
+// bucket, so writers of elements in different stripes don't contend.  The
+// capacity is always a multiple of STRIPE_COUNT, so a bucket's stripe is
+// the same in every table, and two writers to the same bucket always hold
+// the same lock.  A resize locks every stripe (so it waits for, and then
+// holds off, writers, but never readers), builds a complete copy of the
+// table at twice the capacity, and publishes it with a single atomic
+// store.  Readers still walking the old table see a consistent (if
+// slightly stale) view of it, so the old table can't be freed right away;
+// it's "retired" instead, and retired tables are freed by reclaimRetired()
+// -- which may only be called when no thread is in the middle of a
+// contains() -- or when the set is destroyed.  Since the capacity doubles
+// each time, the retired tables together never hold more nodes than the
+// current one.
+//
+// There's no grace-period or epoch scheme to tell when the last reader has
+// left an old table, so a set that's read continuously (by a long-running
+// server, say) never frees its retired tables unless its owner stops the
+// readers and calls reclaimRetired().  Its memory is then bounded by about
+// twice what the current table uses.
+
+#ifndef CONCURRENTHASHSET_HPP
+#define CONCURRENTHASHSET_HPP
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include "Set.hpp"
+
+
+
+template <typename ElementType>
+class ConcurrentHashSet : public Set<ElementType>
+{
+public:
+    // The number of locks that writers are spread across.
+    static constexpr unsigned int STRIPE_COUNT = 64;
+
+    // The default capacity of the ConcurrentHashSet before anything has
+    // been added to it.  Every capacity is a multiple of STRIPE_COUNT.
+    static constexpr unsigned int DEFAULT_CAPACITY = STRIPE_COUNT;
+
+    // A HashFunction is a function that takes a reference to a const
+    // ElementType and returns an unsigned int.  It must be safe to call
+    // from multiple threads at once.
+    using HashFunction = std::function<unsigned int(const ElementType&)>;
+
+public:
+    // Initializes a ConcurrentHashSet to be empty, so that it will use the
+    // given hash function whenever it needs to hash an element.
+    explicit ConcurrentHashSet(HashFunction hashFunction);
+
+    // Cleans up the ConcurrentHashSet, including any retired tables, so that
+    // it leaks no memory.
+    virtual ~ConcurrentHashSet() noexcept;
+
+    // A ConcurrentHashSet is shared between threads by reference, so it
+    // can't be copied or moved.
+    ConcurrentHashSet(const ConcurrentHashSet& s) = delete;
+    ConcurrentHashSet& operator=(const ConcurrentHashSet& s) = delete;
+
+
+    // isImplemented() returns true, since a ConcurrentHashSet is implemented.
+    virtual bool isImplemented() const noexcept override;
+
+
+    // add() adds an element to the set.  If the element is already in the set,
+    // this function has no effect.  It locks the element's stripe and, when
+    // the ratio of size to capacity exceeds 0.8, resizes the table, which
+    // takes linear time and locks every stripe.
+    virtual void add(const ElementType& element) override;
+
+
+    // contains() returns true if the given element is in the set, false
+    // otherwise.  It never locks and never waits for another thread, and
+    // runs in constant time (assuming a good hash function).
+    virtual bool contains(const ElementType& element) const override;
+
+
+    // size() returns the number of elements in the set.
+    virtual unsigned int size() const noexcept override;
+
+
+    // capacity() returns the number of buckets in the current table.
+    unsigned int capacity() const noexcept;
+
+
+    // reclaimRetired() frees the tables that were replaced by resizing.  It
+    // must not be called while any thread might be inside contains().
+    void reclaimRetired() noexcept;
+
+
+private:
+    HashFunction hashFunction;
+
+    class Node {
+    public:
+        const ElementType element;
+        Node* const next;
+
+        Node(const ElementType& e, Node* next) : element(e), next(next) { }
+    };
+
+    class Table {
+    public:
+        unsigned int capacity;
+        std::atomic<Node*>* buckets;
+
+        // tables replaced by a resize are kept in a linked list until
+        // they're reclaimed
+        Table* retiredNext;
+
+        explicit Table(unsigned int capacity);
+        ~Table() noexcept;
+    };
+
+    std::atomic<Table*> table;
+    std::atomic<unsigned int> _size;
+
+    Table* retired;
+
+    mutable std::mutex stripes[STRIPE_COUNT];
+
+    static_assert(DEFAULT_CAPACITY % STRIPE_COUNT == 0,
+        "writers to the same bucket must lock the same stripe");
+
+    // doubles the capacity of the table, unless another thread already
+    // resized it away from "observedCapacity"
+    void resize(unsigned int observedCapacity);
+};
+
+
+
+template <typename ElementType>
+ConcurrentHashSet<ElementType>::Table::Table(unsigned int capacity)
+    : capacity{capacity}, buckets{new std::atomic<Node*>[capacity]}, retiredNext{NULL}
+{
+    for(unsigned int i = 0; i < capacity; i++) {
+        buckets[i].store(NULL, std::memory_order_relaxed);
+    }
+}
+
+
+template <typename ElementType>
+ConcurrentHashSet<ElementType>::Table::~Table() noexcept
+{
+    for(unsigned int i = 0; i < capacity; i++) {
+        Node* workingNode = buckets[i].load(std::memory_order_relaxed);
+        while(workingNode != NULL) {
+            Node* next = workingNode->next;
+            delete workingNode;
+            workingNode = next;
+        }
+    }
+    delete[] buckets;
+}
+
+
+template <typename ElementType>
+ConcurrentHashSet<ElementType>::ConcurrentHashSet(HashFunction hashFunction)
+    : hashFunction{hashFunction}, table{new Table{DEFAULT_CAPACITY}}, _size{0}, retired{NULL}
+{
+}
+
+
+template <typename ElementType>
+ConcurrentHashSet<ElementType>::~ConcurrentHashSet() noexcept
+{
+    reclaimRetired();
+    delete table.load(std::memory_order_relaxed);
+}
+
+
+template <typename ElementType>
+bool ConcurrentHashSet<ElementType>::isImplemented() const noexcept
+{
+    return true;
+}
+
+
+template <typename ElementType>
+void ConcurrentHashSet<ElementType>::add(const ElementType& element)
+{
+    unsigned int hash = hashFunction(element);
+    unsigned int observedCapacity;
+    bool shouldResize;
+
+    {
+        // since every capacity is a multiple of STRIPE_COUNT, this is
+        // (hash % capacity) % STRIPE_COUNT -- the stripe of the element's
+        // bucket -- whichever table is current
+        std::lock_guard<std::mutex> lock{stripes[hash % STRIPE_COUNT]};
+
+        // holding any stripe keeps a resize from replacing the table
+        Table* current = table.load(std::memory_order_relaxed);
+        std::atomic<Node*>& bucket = current->buckets[hash % current->capacity];
+        Node* head = bucket.load(std::memory_order_relaxed);
+
+        for(Node* workingNode = head; workingNode != NULL; workingNode = workingNode->next) {
+            if(workingNode->element == element)
+                return;
+        }
+
+        bucket.store(new Node{element, head}, std::memory_order_release);
+
+        unsigned int newSize = _size.fetch_add(1, std::memory_order_relaxed) + 1;
+        observedCapacity = current->capacity;
+        shouldResize = (double)newSize / observedCapacity > 0.8;
+    }
+
+    if(shouldResize) {
+        resize(observedCapacity);
+    }
+}
+
+
+template <typename ElementType>
+bool ConcurrentHashSet<ElementType>::contains(const ElementType& element) const
+{
+    unsigned int hash = hashFunction(element);
+    const Table* current = table.load(std::memory_order_acquire);
+    const Node* workingNode = current->buckets[hash % current->capacity].load(std::memory_order_acquire);
+
+    while(workingNode != NULL) {
+        if(workingNode->element == element)
+            return true;
+        workingNode = workingNode->next;
+    }
+    return false;
+}
+
+
+template <typename ElementType>
+unsigned int ConcurrentHashSet<ElementType>::size() const noexcept
+{
+    return _size.load(std::memory_order_relaxed);
+}
+
+
+template <typename ElementType>
+unsigned int ConcurrentHashSet<ElementType>::capacity() const noexcept
+{
+    return table.load(std::memory_order_acquire)->capacity;
+}
+
+
+template <typename ElementType>
+void ConcurrentHashSet<ElementType>::reclaimRetired() noexcept
+{
+    for(unsigned int i = 0; i < STRIPE_COUNT; i++) {
+        stripes[i].lock();
+    }
+
+    while(retired != NULL) {
+        Table* next = retired->retiredNext;
+        delete retired;
+        retired = next;
+    }
+
+    for(unsigned int i = STRIPE_COUNT; i > 0; i--) {
+        stripes[i - 1].unlock();
+    }
+}
+
+
+template <typename ElementType>
+void ConcurrentHashSet<ElementType>::resize(unsigned int observedCapacity)
+{
+    // always lock in the same order, so two resizes can't deadlock
+    for(unsigned int i = 0; i < STRIPE_COUNT; i++) {
+        stripes[i].lock();
+    }
+
+    Table* current = table.load(std::memory_order_relaxed);
+
+    if(current->capacity == observedCapacity) {
+        // readers may still be walking the current nodes, so copy them
+        // rather than relinking them into the new table
+        Table* grown = new Table{2 * current->capacity};
+
+        for(unsigned int i = 0; i < current->capacity; i++) {
+            Node* workingNode = current->buckets[i].load(std::memory_order_relaxed);
+            while(workingNode != NULL) {
+                std::atomic<Node*>& bucket = grown->buckets[hashFunction(workingNode->element) % grown->capacity];
+                bucket.store(new Node{workingNode->element, bucket.load(std::memory_order_relaxed)}, std::memory_order_relaxed);
+                workingNode = workingNode->next;
+            }
+        }
+
+        table.store(grown, std::memory_order_release);
+
+        current->retiredNext = retired;
+        retired = current;
+    }
+
+    for(unsigned int i = STRIPE_COUNT; i > 0; i--) {
+        stripes[i - 1].unlock();
+    }
+}
+
+
+
+#endif // CONCURRENTHASHSET_HPP
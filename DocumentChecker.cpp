@@ -0,0 +1,125 @@
+// DocumentChecker.cpp
+//
+// ICS 46 Spring 2018
+// Project #4: Set the Controls for the Heart of the Sun
+
+#include "DocumentChecker.hpp"
+
+#include <cctype>
+#include <string_view>
+#include <unordered_map>
+
+
+
+namespace
+{
+    bool isLetter(char c)
+    {
+        return std::isalpha(static_cast<unsigned char>(c)) != 0;
+    }
+
+
+    // What's known about one distinct token: where it first occurs (so it
+    // can be checked once), and the result of checking it.
+    struct Entry
+    {
+        std::string::size_type position;
+        std::string::size_type length;
+        bool correct;
+        unsigned int suggestions;
+    };
+}
+
+
+
+DocumentChecker::DocumentChecker(const WordChecker& checker, bool withSuggestions)
+    : checker{checker}, withSuggestions{withSuggestions}
+{
+}
+
+
+DocumentChecker::Report DocumentChecker::check(const std::string& document) const
+{
+    Report report;
+
+    // first, find the tokens and collapse them into distinct entries,
+    // remembering which entry each token belongs to
+    std::vector<Entry> entries;
+    std::vector<unsigned int> entryOfToken;
+    std::unordered_map<std::string_view, unsigned int> entryOfText;
+
+    // a rough guess of one token per six characters, and of one distinct
+    // token per ten tokens, saves most of the rehashing
+    report.tokens.reserve(document.size() / 6);
+    entryOfToken.reserve(document.size() / 6);
+    entryOfText.reserve(document.size() / 60 + 16);
+
+    std::string::size_type i = 0;
+    while(i < document.size()) {
+        if(!isLetter(document[i])) {
+            i++;
+            continue;
+        }
+
+        std::string::size_type start = i;
+        while(i < document.size() && isLetter(document[i])) {
+            i++;
+        }
+
+        std::string_view text{document.data() + start, i - start};
+        auto inserted = entryOfText.emplace(text, static_cast<unsigned int>(entries.size()));
+        if(inserted.second) {
+            entries.push_back(Entry{start, i - start, false, 0});
+        }
+
+        report.tokens.push_back(Token{start, i - start, false, 0});
+        entryOfToken.push_back(inserted.first->second);
+    }
+
+    report.stats.tokens = report.tokens.size();
+    report.stats.uniqueTokens = entries.size();
+
+    // then check each distinct token once; tokens that differ only in case
+    // (such as a word at the start of a sentence) share one check
+    std::unordered_map<std::string, unsigned int> entryOfWord;
+    entryOfWord.reserve(entries.size());
+
+    std::string word;
+    for(Entry& entry : entries) {
+        word.assign(document, entry.position, entry.length);
+        for(char& c : word) {
+            c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        }
+
+        auto inserted = entryOfWord.emplace(word, static_cast<unsigned int>(&entry - entries.data()));
+        if(!inserted.second) {
+            const Entry& checked = entries[inserted.first->second];
+            entry.correct = checked.correct;
+            entry.suggestions = checked.suggestions;
+            continue;
+        }
+
+        entry.correct = checker.wordExists(word);
+        report.stats.lookups++;
+
+        if(!entry.correct) {
+            entry.suggestions = static_cast<unsigned int>(report.suggestions.size());
+            if(withSuggestions) {
+                report.suggestions.push_back(checker.findSuggestions(word));
+                report.stats.suggestionLookups++;
+            }
+            else {
+                report.suggestions.emplace_back();
+            }
+        }
+    }
+
+    // and finally copy each entry's result to all of its tokens
+    for(std::size_t t = 0; t < report.tokens.size(); t++) {
+        const Entry& entry = entries[entryOfToken[t]];
+        report.tokens[t].correct = entry.correct;
+        report.tokens[t].suggestions = entry.suggestions;
+    }
+
+    return report;
+}
@@ -0,0 +1,89 @@
+// DocumentChecker.hpp
+//
+// ICS 46 Spring 2018
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// A DocumentChecker checks the spelling of every word in a document using a
+// WordChecker.  Since natural text uses the same words over and over, it
+// doesn't check each occurrence: it first collapses the document's words
+// ("tokens") into the distinct ones, using a hash table keyed by views into
+// the document so that no token is copied, then checks each distinct token
+// once -- one wordExists() and, if it's misspelled, one findSuggestions() --
+// and finally reports the result at every position where the token occurs.
+//
+// A token is a maximal run of letters.  Tokens are converted to upper case
+// before they're checked, to match the word sets used with WordChecker, so
+// tokens that differ only in case are checked once, too.
+//
+// You are permitted to use the C++ Standard Library in this class.
+
+#ifndef DOCUMENTCHECKER_HPP
+#define DOCUMENTCHECKER_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "WordChecker.hpp"
+
+
+
+class DocumentChecker
+{
+public:
+    // A Token is one occurrence of a word in the document.  If it's
+    // misspelled, "suggestions" is the index in Report::suggestions of the
+    // suggestions for it, which all occurrences of the same word share.
+    struct Token
+    {
+        std::string::size_type position;
+        std::string::size_type length;
+        bool correct;
+        unsigned int suggestions;
+    };
+
+    // Stats counts the work done checking a document: the number of
+    // tokens, the number of distinct tokens, and the number of calls made
+    // to wordExists() and findSuggestions().  There can be fewer lookups
+    // than distinct tokens, since tokens that differ only in case are
+    // checked once.  Without deduplication, there would be one lookup per
+    // token.
+    struct Stats
+    {
+        std::size_t tokens = 0;
+        std::size_t uniqueTokens = 0;
+        std::size_t lookups = 0;
+        std::size_t suggestionLookups = 0;
+    };
+
+    struct Report
+    {
+        // every token in the document, in order
+        std::vector<Token> tokens;
+
+        // the suggestions for each distinct misspelled token
+        std::vector<std::vector<std::string>> suggestions;
+
+        Stats stats;
+    };
+
+public:
+    // Initializes a DocumentChecker that uses the given WordChecker, which
+    // must outlive it.  If "withSuggestions" is false, misspelled tokens
+    // are reported without suggestions (and findSuggestions() isn't called).
+    explicit DocumentChecker(const WordChecker& checker, bool withSuggestions = true);
+
+
+    // check() checks every token in the document.  The document must not
+    // change while check() is running, but the Report refers to it only by
+    // position, so it can be changed (or discarded) afterward.
+    Report check(const std::string& document) const;
+
+
+private:
+    const WordChecker& checker;
+    bool withSuggestions;
+};
+
+
+
+#endif // DOCUMENTCHECKER_HPP
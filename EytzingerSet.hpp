@@ -0,0 +1,471 @@
+// EytzingerSet.hpp
+//
+// ICS 46 Spring 2018
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// An EytzingerSet is a frozen, ordered implementation of a Set.  Rather than
+// linking dynamically-allocated nodes together with pointers, as AVLSet
+// does, it stores its elements in a single dynamically-allocated array in
+// breadth-first ("Eytzinger") order: the root of an implicit balanced
+// binary search tree is at index 1, and the children of the element at
+// index k are at indices 2k and 2k + 1.
+//
+// Because the shape of the tree is implied by the indices, a lookup needs
+// no pointers and no recursion.  contains() walks down the array with a
+// loop whose only data-dependent step is which child to move to, computed
+// arithmetically rather than with a branch, and prefetches the elements a
+// few levels further down while the current comparison is in flight.  The
+// first levels of the tree are also packed together at the front of the
+// array, so they tend to stay in the cache across lookups.
+//
+// An EytzingerSet is meant to be built once -- from an AVLSet or from an
+// array of elements that's already sorted -- and then only read.  add() is
+// supported, so that an EytzingerSet is a complete Set, but it rebuilds the
+// whole array and runs in linear time.
+
+#ifndef EYTZINGERSET_HPP
+#define EYTZINGERSET_HPP
+
+#include <functional>
+#include <utility>
+#include "AVLSet.hpp"
+#include "Set.hpp"
+
+
+
+template <typename ElementType>
+class EytzingerSet : public Set<ElementType>
+{
+public:
+    // A VisitFunction is a function that takes a reference to a const
+    // ElementType and returns no value.
+    using VisitFunction = std::function<void(const ElementType&)>;
+
+    // The number of levels below the current one whose first element is
+    // prefetched during a lookup.  Sixteen descendants four levels down are
+    // contiguous in the array, so one prefetch covers all of them.
+    static constexpr unsigned int PREFETCH_LEVELS = 4;
+
+    // containsMany() looks up elements in groups of this many.
+    static constexpr unsigned int LOOKUP_GROUP_SIZE = 16;
+
+public:
+    // Initializes an EytzingerSet to be empty.
+    EytzingerSet();
+
+    // Initializes an EytzingerSet containing the elements of an AVLSet.
+    explicit EytzingerSet(const AVLSet<ElementType>& s);
+
+    // Initializes an EytzingerSet containing the given elements, which must
+    // be sorted in ascending order.  Duplicate elements are only stored once.
+    EytzingerSet(const ElementType* sortedElements, unsigned int count);
+
+    // Cleans up the EytzingerSet so that it leaks no memory.
+    virtual ~EytzingerSet() noexcept;
+
+    // Initializes a new EytzingerSet to be a copy of an existing one.
+    EytzingerSet(const EytzingerSet& s);
+
+    // Initializes a new EytzingerSet whose contents are moved from an
+    // expiring one.
+    EytzingerSet(EytzingerSet&& s) noexcept;
+
+    // Assigns an existing EytzingerSet into another.
+    EytzingerSet& operator=(const EytzingerSet& s);
+
+    // Assigns an expiring EytzingerSet into another.
+    EytzingerSet& operator=(EytzingerSet&& s) noexcept;
+
+
+    // isImplemented() returns true, since an EytzingerSet is implemented.
+    virtual bool isImplemented() const noexcept override;
+
+
+    // add() adds an element to the set.  If the element is already in the set,
+    // this function has no effect.  Since the array has to be laid out again,
+    // this function runs in O(n) time when there are n elements in the set;
+    // it's meant for occasional use, not for building the set.
+    virtual void add(const ElementType& element) override;
+
+
+    // contains() returns true if the given element is already in the set,
+    // false otherwise.  This function always runs in O(log n) time when
+    // there are n elements in the set.
+    virtual bool contains(const ElementType& element) const override;
+
+
+    // containsMany() sets results[i] to contains(elements[i]) for each of
+    // the "count" elements.  It descends for LOOKUP_GROUP_SIZE elements at a
+    // time, moving every one of them down a level before moving any of them
+    // further, and prefetching the nodes they'll visit next, so the cache
+    // misses of the whole group overlap.
+    void containsMany(const ElementType* elements, unsigned int count, bool* results) const;
+
+
+    // size() returns the number of elements in the set.
+    virtual unsigned int size() const noexcept override;
+
+
+    // height() returns the height of the implicit tree.  Note that, by
+    // definition, the height of an empty tree is -1.
+    int height() const noexcept;
+
+
+    // inorder() calls the given "visit" function for each of the elements
+    // in the set, in ascending order.
+    void inorder(VisitFunction visit) const;
+
+
+    // range() calls the given "visit" function, in ascending order, for each
+    // of the elements in the set that are at least "low" and at most "high".
+    // This function runs in O(log n + k) time, where k is the number of
+    // elements visited.
+    void range(const ElementType& low, const ElementType& high, VisitFunction visit) const;
+
+
+private:
+    // The elements are stored in array[1] through array[count]; array[0]
+    // is unused, so that the children of index k are always 2k and 2k + 1.
+    ElementType* array;
+    unsigned int count;
+
+    // Lays out "n" sorted, distinct elements into a newly-allocated array.
+    void build(const ElementType* sortedElements, unsigned int n);
+
+    // Recursively copies sorted elements into the subtree rooted at "index",
+    // returning the position of the next sorted element to be placed.
+    unsigned int fill(const ElementType* sortedElements, unsigned int next, unsigned int index);
+
+    // Returns the index of the smallest element not less than "element",
+    // or 0 if there is no such element.
+    unsigned int lowerBoundIndex(const ElementType& element) const;
+
+    // Returns the index of the element that follows "index" in ascending
+    // order, or 0 if "index" holds the largest element.
+    unsigned int successorIndex(unsigned int index) const noexcept;
+
+    // Returns the index of the smallest element in the set, or 0 if the set
+    // is empty.
+    unsigned int firstIndex() const noexcept;
+};
+
+
+
+template <typename ElementType>
+EytzingerSet<ElementType>::EytzingerSet()
+    : array{NULL}, count{0}
+{
+}
+
+
+template <typename ElementType>
+EytzingerSet<ElementType>::EytzingerSet(const AVLSet<ElementType>& s)
+    : array{NULL}, count{0}
+{
+    unsigned int n = s.size();
+    ElementType* sortedElements = new ElementType[n == 0 ? 1 : n];
+    unsigned int next = 0;
+
+    s.inorder([&](const ElementType& element) { sortedElements[next++] = element; });
+
+    build(sortedElements, next);
+    delete[] sortedElements;
+}
+
+
+template <typename ElementType>
+EytzingerSet<ElementType>::EytzingerSet(const ElementType* sortedElements, unsigned int count)
+    : array{NULL}, count{0}
+{
+    // drop duplicates, so that the layout only holds distinct elements
+    ElementType* distinct = new ElementType[count == 0 ? 1 : count];
+    unsigned int n = 0;
+
+    for(unsigned int i = 0; i < count; i++) {
+        if(n == 0 || !(distinct[n - 1] == sortedElements[i])) {
+            distinct[n++] = sortedElements[i];
+        }
+    }
+
+    build(distinct, n);
+    delete[] distinct;
+}
+
+
+template <typename ElementType>
+EytzingerSet<ElementType>::~EytzingerSet() noexcept
+{
+    delete[] array;
+}
+
+
+template <typename ElementType>
+EytzingerSet<ElementType>::EytzingerSet(const EytzingerSet& s)
+    : array{NULL}, count{s.count}
+{
+    if(s.array != NULL) {
+        array = new ElementType[count + 1];
+        for(unsigned int i = 1; i <= count; i++) {
+            array[i] = s.array[i];
+        }
+    }
+}
+
+
+template <typename ElementType>
+EytzingerSet<ElementType>::EytzingerSet(EytzingerSet&& s) noexcept
+    : array{s.array}, count{s.count}
+{
+    s.array = NULL;
+    s.count = 0;
+}
+
+
+template <typename ElementType>
+EytzingerSet<ElementType>& EytzingerSet<ElementType>::operator=(const EytzingerSet& s)
+{
+    if(this != &s) {
+        EytzingerSet copy{s};
+        std::swap(array, copy.array);
+        std::swap(count, copy.count);
+    }
+    return *this;
+}
+
+
+template <typename ElementType>
+EytzingerSet<ElementType>& EytzingerSet<ElementType>::operator=(EytzingerSet&& s) noexcept
+{
+    std::swap(array, s.array);
+    std::swap(count, s.count);
+    return *this;
+}
+
+
+template <typename ElementType>
+bool EytzingerSet<ElementType>::isImplemented() const noexcept
+{
+    return true;
+}
+
+
+template <typename ElementType>
+void EytzingerSet<ElementType>::add(const ElementType& element)
+{
+    if(contains(element)) {
+        return;
+    }
+
+    // gather the elements in order, slotting the new one into place
+    ElementType* sortedElements = new ElementType[count + 1];
+    unsigned int next = 0;
+    bool placed = false;
+
+    for(unsigned int i = firstIndex(); i != 0; i = successorIndex(i)) {
+        if(!placed && element < array[i]) {
+            sortedElements[next++] = element;
+            placed = true;
+        }
+        sortedElements[next++] = array[i];
+    }
+    if(!placed) {
+        sortedElements[next++] = element;
+    }
+
+    delete[] array;
+    array = NULL;
+    count = 0;
+
+    build(sortedElements, next);
+    delete[] sortedElements;
+}
+
+
+template <typename ElementType>
+bool EytzingerSet<ElementType>::contains(const ElementType& element) const
+{
+    unsigned int index = lowerBoundIndex(element);
+    return index != 0 && array[index] == element;
+}
+
+
+template <typename ElementType>
+unsigned int EytzingerSet<ElementType>::size() const noexcept
+{
+    return count;
+}
+
+
+template <typename ElementType>
+int EytzingerSet<ElementType>::height() const noexcept
+{
+    int h = -1;
+    for(unsigned int n = count; n != 0; n >>= 1) {
+        h++;
+    }
+    return h;
+}
+
+
+template <typename ElementType>
+void EytzingerSet<ElementType>::inorder(VisitFunction visit) const
+{
+    for(unsigned int i = firstIndex(); i != 0; i = successorIndex(i)) {
+        visit(array[i]);
+    }
+}
+
+
+template <typename ElementType>
+void EytzingerSet<ElementType>::range(const ElementType& low, const ElementType& high, VisitFunction visit) const
+{
+    for(unsigned int i = lowerBoundIndex(low); i != 0 && !(high < array[i]); i = successorIndex(i)) {
+        visit(array[i]);
+    }
+}
+
+
+template <typename ElementType>
+void EytzingerSet<ElementType>::build(const ElementType* sortedElements, unsigned int n)
+{
+    count = n;
+    if(n == 0) {
+        array = NULL;
+        return;
+    }
+
+    array = new ElementType[n + 1];
+    fill(sortedElements, 0, 1);
+}
+
+
+template <typename ElementType>
+unsigned int EytzingerSet<ElementType>::fill(const ElementType* sortedElements, unsigned int next, unsigned int index)
+{
+    // an inorder walk of the implicit tree visits the indices in ascending
+    // order of their elements, so hand out the sorted elements in that order
+    if(index <= count) {
+        next = fill(sortedElements, next, 2 * index);
+        array[index] = sortedElements[next++];
+        next = fill(sortedElements, next, 2 * index + 1);
+    }
+    return next;
+}
+
+
+template <typename ElementType>
+void EytzingerSet<ElementType>::containsMany(const ElementType* elements, unsigned int count, bool* results) const
+{
+    unsigned int indexes[LOOKUP_GROUP_SIZE];
+
+    for(unsigned int first = 0; first < count; first += LOOKUP_GROUP_SIZE) {
+        unsigned int groupSize = count - first < LOOKUP_GROUP_SIZE ? count - first : LOOKUP_GROUP_SIZE;
+
+        for(unsigned int i = 0; i < groupSize; i++) {
+            indexes[i] = 1;
+        }
+
+        // every descent takes the same number of steps, give or take one,
+        // so the group moves down the tree together
+        bool moving = true;
+        while(moving) {
+            moving = false;
+            for(unsigned int i = 0; i < groupSize; i++) {
+                unsigned int index = indexes[i];
+                if(index > this->count) {
+                    continue;
+                }
+
+                index = 2 * index + static_cast<unsigned int>(array[index] < elements[first + i]);
+                indexes[i] = index;
+#if defined(__GNUC__)
+                if(index <= this->count) {
+                    __builtin_prefetch(array + index);
+                }
+#endif
+                moving = true;
+            }
+        }
+
+        for(unsigned int i = 0; i < groupSize; i++) {
+            // undo the trailing right turns, as in lowerBoundIndex()
+            unsigned int index = indexes[i];
+            unsigned int trailingRightTurns = 0;
+            while((index >> trailingRightTurns) & 1) {
+                trailingRightTurns++;
+            }
+            index >>= trailingRightTurns + 1;
+
+            results[first + i] = index != 0 && array[index] == elements[first + i];
+        }
+    }
+}
+
+
+template <typename ElementType>
+unsigned int EytzingerSet<ElementType>::lowerBoundIndex(const ElementType& element) const
+{
+    unsigned int index = 1;
+
+    while(index <= count) {
+#if defined(__GNUC__)
+        // the 2^PREFETCH_LEVELS descendants this many levels down sit next to
+        // each other, so one prefetch brings in the start of all of them;
+        // the address is only formed when it's inside the array
+        unsigned int ahead = index << PREFETCH_LEVELS;
+        if(ahead <= count) {
+            __builtin_prefetch(array + ahead);
+        }
+#endif
+        // go left (2k) when array[k] >= element, right (2k + 1) otherwise
+        index = 2 * index + static_cast<unsigned int>(array[index] < element);
+    }
+
+    // the path taken ends with a right turn for every element smaller than
+    // the one we want; undoing those right turns, and then the last left
+    // turn, lands on the lower bound (or on 0, if every element is smaller)
+    unsigned int trailingRightTurns = 0;
+    while((index >> trailingRightTurns) & 1) {
+        trailingRightTurns++;
+    }
+    return index >> (trailingRightTurns + 1);
+}
+
+
+template <typename ElementType>
+unsigned int EytzingerSet<ElementType>::successorIndex(unsigned int index) const noexcept
+{
+    if(2 * index + 1 <= count) {
+        // the successor is the leftmost element of the right subtree
+        index = 2 * index + 1;
+        while(2 * index <= count) {
+            index = 2 * index;
+        }
+        return index;
+    }
+
+    // otherwise, climb until we come up from a left child
+    while(index & 1) {
+        index >>= 1;
+    }
+    return index >> 1;
+}
+
+
+template <typename ElementType>
+unsigned int EytzingerSet<ElementType>::firstIndex() const noexcept
+{
+    if(count == 0) {
+        return 0;
+    }
+
+    unsigned int index = 1;
+    while(2 * index <= count) {
+        index = 2 * index;
+    }
+    return index;
+}
+
+
+
+#endif // EYTZINGERSET_HPP
@@ -24,6 +24,7 @@
 #define HASHSET_HPP
 
 #include <functional>
+#include "ParallelBuild.hpp"
 #include "Set.hpp"
 
 
@@ -36,6 +37,9 @@ public:
     // added to it.
     static constexpr unsigned int DEFAULT_CAPACITY = 10;
 
+    // containsMany() looks up elements in groups of this many.
+    static constexpr unsigned int LOOKUP_GROUP_SIZE = 16;
+
     // A HashFunction is a function that takes a reference to a const
     // ElementType and returns an unsigned int.
     using HashFunction = std::function<unsigned int(const ElementType&)>;
@@ -77,12 +81,66 @@ public:
     virtual void add(const ElementType& element) override;
 
 
+    // addAll() adds an array of elements to the set, skipping any that are
+    // already in it, using the given number of threads.  The array is grown
+    // once, up front, to its final capacity.  The elements are then hashed
+    // in parallel and partitioned by the range of buckets they hash into,
+    // and each thread links the elements of one range into their buckets,
+    // so no two threads ever touch the same bucket.
+    void addAll(const ElementType* elements, unsigned int count, unsigned int threadCount = defaultThreadCount());
+
+
+    // unionWith(), intersectWith() and differenceWith() replace the contents
+    // of this set with its union, intersection or difference with another
+    // HashSet, leaving the other set unchanged.  Both sets must use the same
+    // hash function.  The work is divided among the given number of threads
+    // by bucket: for a union, this set's array is first grown (if needed) to
+    // a multiple of the other's capacity, so the elements of different
+    // buckets in the other set always land in different buckets here, and
+    // each thread merges its own range of the other's buckets; for the
+    // others, each thread filters its own range of this set's buckets.
+    void unionWith(const HashSet& other, unsigned int threadCount = defaultThreadCount());
+    void intersectWith(const HashSet& other, unsigned int threadCount = defaultThreadCount());
+    void differenceWith(const HashSet& other, unsigned int threadCount = defaultThreadCount());
+
+
     // contains() returns true if the given element is already in the set,
     // false otherwise.  This function runs in constant time (with respect
     // to the number of elements, assuming a good hash function).
     virtual bool contains(const ElementType& element) const override;
 
 
+    // containsMany() sets results[i] to contains(elements[i]) for each of
+    // the "count" elements.  Rather than waiting on each lookup's cache
+    // misses in turn, it works on LOOKUP_GROUP_SIZE elements at a time:
+    // it hashes all of them and prefetches their buckets, then reads the
+    // buckets and prefetches the first node of each chain, and only then
+    // compares elements, so the misses of a whole group overlap.
+    void containsMany(const ElementType* elements, unsigned int count, bool* results) const;
+
+
+    // containsHashed() returns true if the bucket for the given hash (which
+    // must be what this set's hash function would return for the element
+    // being looked for) holds an element for which matches(element) returns
+    // true.  It lets a caller that can compute the hash of an element
+    // cheaply, and compare against it without building it, look it up.
+    template <typename Matcher>
+    bool containsHashed(unsigned int hash, Matcher matches) const;
+
+
+    // containsManyHashed() sets results[i] to true if the bucket for
+    // hashes[i] holds an element for which matches(i, element) returns true,
+    // for each of the "count" hashes.  Like containsMany(), it prefetches
+    // the buckets of a group before comparing any elements.
+    template <typename Matcher>
+    void containsManyHashed(const unsigned int* hashes, unsigned int count, Matcher matches, bool* results) const;
+
+
+    // hashFunctionIs() returns true if this set was given the given function
+    // (not a wrapper around it) as its hash function.
+    bool hashFunctionIs(unsigned int (*function)(const ElementType&)) const;
+
+
     // size() returns the number of elements in the set.
     virtual unsigned int size() const noexcept override;
 
@@ -134,6 +192,17 @@ private:
 
     // resize array
     void resize();
+
+    // moves every node into a new array with the given capacity, placing
+    // each one in the bucket its element hashes to
+    void rehash(int newCapacity);
+
+    // returns true if the element is in the chain at the given index
+    bool isInBucket(const ElementType& element, unsigned int index) const;
+
+    // removes, in parallel, every element for which "keep" returns false
+    template <typename Predicate>
+    void filterParallel(Predicate keep, unsigned int threadCount);
 };
 
 
@@ -332,26 +401,353 @@ bool HashSet<ElementType>::isElementAtIndex(const ElementType& element, unsigned
 template <typename ElementType>
 void HashSet<ElementType>::resize() 
 {
-    Node** newArray = new Node*[2 * capacity];
-    
-    for(auto i = 0; i < capacity; i++) {
-        if(array[i] != NULL)
-            newArray[i] = new Node(array[i]);
-        else
-            newArray[i] = NULL;
+    rehash(2 * capacity);
+}
+
+
+template <typename ElementType>
+void HashSet<ElementType>::rehash(int newCapacity)
+{
+    Node** newArray = new Node*[newCapacity];
+
+    for(auto i = 0; i < newCapacity; i++) {
+        newArray[i] = NULL;
     }
 
+    // relink the existing nodes rather than copying them
     for(auto i = 0; i < capacity; i++) {
-        delete array[i];
-    }   
+        Node* workingNode = array[i];
+        while(workingNode != NULL) {
+            Node* next = workingNode->next;
+            int index = hashFunction(workingNode->element) % newCapacity;
+            workingNode->next = newArray[index];
+            newArray[index] = workingNode;
+            workingNode = next;
+        }
+    }
+
     delete[] array;
-    
+
     array = newArray;
-    
-    capacity *= 2;
+    capacity = newCapacity;
+}
+
+
+template <typename ElementType>
+void HashSet<ElementType>::containsMany(const ElementType* elements, unsigned int count, bool* results) const
+{
+    unsigned int indexes[LOOKUP_GROUP_SIZE];
+    Node* heads[LOOKUP_GROUP_SIZE];
+
+    for(unsigned int first = 0; first < count; first += LOOKUP_GROUP_SIZE) {
+        unsigned int groupSize = count - first < LOOKUP_GROUP_SIZE ? count - first : LOOKUP_GROUP_SIZE;
+
+        for(unsigned int i = 0; i < groupSize; i++) {
+            indexes[i] = hashFunction(elements[first + i]) % capacity;
+#if defined(__GNUC__)
+            __builtin_prefetch(array + indexes[i]);
+#endif
+        }
+
+        for(unsigned int i = 0; i < groupSize; i++) {
+            heads[i] = array[indexes[i]];
+#if defined(__GNUC__)
+            if(heads[i] != NULL) {
+                __builtin_prefetch(heads[i]);
+            }
+#endif
+        }
+
+        for(unsigned int i = 0; i < groupSize; i++) {
+            bool found = false;
+            for(Node* workingNode = heads[i]; workingNode != NULL; workingNode = workingNode->next) {
+                if(workingNode->element == elements[first + i]) {
+                    found = true;
+                    break;
+                }
+            }
+            results[first + i] = found;
+        }
+    }
+}
+
+
+template <typename ElementType>
+template <typename Matcher>
+bool HashSet<ElementType>::containsHashed(unsigned int hash, Matcher matches) const
+{
+    for(Node* workingNode = array[hash % capacity]; workingNode != NULL; workingNode = workingNode->next) {
+        if(matches(workingNode->element)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+template <typename ElementType>
+template <typename Matcher>
+void HashSet<ElementType>::containsManyHashed(const unsigned int* hashes, unsigned int count, Matcher matches, bool* results) const
+{
+    Node* heads[LOOKUP_GROUP_SIZE];
+
+    for(unsigned int first = 0; first < count; first += LOOKUP_GROUP_SIZE) {
+        unsigned int groupSize = count - first < LOOKUP_GROUP_SIZE ? count - first : LOOKUP_GROUP_SIZE;
+
+#if defined(__GNUC__)
+        for(unsigned int i = 0; i < groupSize; i++) {
+            __builtin_prefetch(array + hashes[first + i] % capacity);
+        }
+#endif
+
+        for(unsigned int i = 0; i < groupSize; i++) {
+            heads[i] = array[hashes[first + i] % capacity];
+#if defined(__GNUC__)
+            if(heads[i] != NULL) {
+                __builtin_prefetch(heads[i]);
+            }
+#endif
+        }
+
+        for(unsigned int i = 0; i < groupSize; i++) {
+            bool found = false;
+            for(Node* workingNode = heads[i]; workingNode != NULL; workingNode = workingNode->next) {
+                if(matches(first + i, workingNode->element)) {
+                    found = true;
+                    break;
+                }
+            }
+            results[first + i] = found;
+        }
+    }
+}
+
+
+template <typename ElementType>
+bool HashSet<ElementType>::hashFunctionIs(unsigned int (*function)(const ElementType&)) const
+{
+    auto target = hashFunction.template target<unsigned int (*)(const ElementType&)>();
+    return target != NULL && *target == function;
+}
+
+
+template <typename ElementType>
+bool HashSet<ElementType>::isInBucket(const ElementType& element, unsigned int index) const
+{
+    for(Node* workingNode = array[index]; workingNode != NULL; workingNode = workingNode->next) {
+        if(workingNode->element == element)
+            return true;
+    }
+    return false;
+}
+
+
+template <typename ElementType>
+void HashSet<ElementType>::addAll(const ElementType* elements, unsigned int count, unsigned int threadCount)
+{
+    if(count == 0) {
+        return;
+    }
+    if(threadCount == 0) {
+        threadCount = 1;
+    }
+
+    int newCapacity = capacity;
+    while( (double)(_size + count) / newCapacity > 0.8) {
+        newCapacity *= 2;
+    }
+    if(newCapacity != capacity) {
+        rehash(newCapacity);
+    }
+
+    const unsigned int threads = threadCount;
+    const unsigned int buckets = capacity;
+
+    // thread t owns the buckets whose index i has i * threads / buckets == t
+    auto partitionOf = [&](unsigned int index) {
+        return static_cast<unsigned int>(static_cast<unsigned long long>(index) * threads / buckets);
+    };
+
+    unsigned int* indices = new unsigned int[count];
+    unsigned int* order = new unsigned int[count];
+
+    // offsets[p * threads + c] counts, and then locates, the elements from
+    // chunk c that fall into partition p
+    unsigned int* offsets = new unsigned int[threads * threads];
+    unsigned int* partitionStart = new unsigned int[threads + 1];
+    unsigned int* added = new unsigned int[threads];
+
+    for(unsigned int i = 0; i < threads * threads; i++) {
+        offsets[i] = 0;
+    }
+
+    // hash each chunk, counting how many of its elements go to each partition
+    parallelFor(threads, [&](unsigned int t) {
+        unsigned int begin, end;
+        chunkBounds(count, threads, t, begin, end);
+
+        for(unsigned int i = begin; i < end; i++) {
+            indices[i] = hashFunction(elements[i]) % buckets;
+            offsets[partitionOf(indices[i]) * threads + t]++;
+        }
+    });
+
+    unsigned int running = 0;
+    for(unsigned int p = 0; p < threads; p++) {
+        partitionStart[p] = running;
+        for(unsigned int c = 0; c < threads; c++) {
+            unsigned int n = offsets[p * threads + c];
+            offsets[p * threads + c] = running;
+            running += n;
+        }
+    }
+    partitionStart[threads] = running;
+
+    // scatter the elements' positions so each partition's are contiguous
+    parallelFor(threads, [&](unsigned int t) {
+        unsigned int begin, end;
+        chunkBounds(count, threads, t, begin, end);
+
+        for(unsigned int i = begin; i < end; i++) {
+            order[offsets[partitionOf(indices[i]) * threads + t]++] = i;
+        }
+    });
+
+    // link each partition's elements into its own buckets
+    parallelFor(threads, [&](unsigned int t) {
+        added[t] = 0;
+
+        for(unsigned int k = partitionStart[t]; k < partitionStart[t + 1]; k++) {
+            unsigned int i = order[k];
+            unsigned int index = indices[i];
+
+            if(!isInBucket(elements[i], index)) {
+                Node* newNode = new Node(elements[i]);
+                newNode->next = array[index];
+                array[index] = newNode;
+                added[t]++;
+            }
+        }
+    });
+
+    for(unsigned int t = 0; t < threads; t++) {
+        _size += added[t];
+    }
+
+    delete[] added;
+    delete[] partitionStart;
+    delete[] offsets;
+    delete[] order;
+    delete[] indices;
+}
+
+
+template <typename ElementType>
+void HashSet<ElementType>::unionWith(const HashSet& other, unsigned int threadCount)
+{
+    if(threadCount == 0) {
+        threadCount = 1;
+    }
+
+    int newCapacity = capacity;
+    while(newCapacity < other.capacity || (double)(_size + other._size) / newCapacity > 0.8) {
+        newCapacity *= 2;
+    }
+    if(newCapacity != capacity) {
+        rehash(newCapacity);
+    }
+
+    if(capacity % other.capacity != 0) {
+        // the bucket ranges wouldn't be disjoint, so merge on one thread
+        threadCount = 1;
+    }
+
+    unsigned int* added = new unsigned int[threadCount];
+
+    parallelFor(threadCount, [&](unsigned int t) {
+        unsigned int begin, end;
+        chunkBounds(other.capacity, threadCount, t, begin, end);
+        added[t] = 0;
+
+        // an element in the other's bucket i lands in one of our buckets
+        // i, i + other.capacity, i + 2 * other.capacity, ..., which no
+        // other thread's range of the other's buckets can reach
+        for(unsigned int i = begin; i < end; i++) {
+            for(Node* workingNode = other.array[i]; workingNode != NULL; workingNode = workingNode->next) {
+                unsigned int index = hashFunction(workingNode->element) % capacity;
+                if(!isInBucket(workingNode->element, index)) {
+                    Node* newNode = new Node(workingNode->element);
+                    newNode->next = array[index];
+                    array[index] = newNode;
+                    added[t]++;
+                }
+            }
+        }
+    });
+
+    for(unsigned int t = 0; t < threadCount; t++) {
+        _size += added[t];
+    }
+    delete[] added;
 }
 
 
+template <typename ElementType>
+void HashSet<ElementType>::intersectWith(const HashSet& other, unsigned int threadCount)
+{
+    filterParallel([&](const ElementType& element) { return other.contains(element); }, threadCount);
+}
+
+
+template <typename ElementType>
+void HashSet<ElementType>::differenceWith(const HashSet& other, unsigned int threadCount)
+{
+    filterParallel([&](const ElementType& element) { return !other.contains(element); }, threadCount);
+}
+
+
+template <typename ElementType>
+template <typename Predicate>
+void HashSet<ElementType>::filterParallel(Predicate keep, unsigned int threadCount)
+{
+    if(threadCount == 0) {
+        threadCount = 1;
+    }
+
+    unsigned int* removed = new unsigned int[threadCount];
+
+    parallelFor(threadCount, [&](unsigned int t) {
+        unsigned int begin, end;
+        chunkBounds(capacity, threadCount, t, begin, end);
+        removed[t] = 0;
+
+        for(unsigned int i = begin; i < end; i++) {
+            Node** link = &array[i];
+            while(*link != NULL) {
+                Node* workingNode = *link;
+                if(keep(workingNode->element)) {
+                    link = &workingNode->next;
+                }
+                else {
+                    // detach the node first, since deleting a node deletes
+                    // the rest of its chain
+                    *link = workingNode->next;
+                    workingNode->next = NULL;
+                    delete workingNode;
+                    removed[t]++;
+                }
+            }
+        }
+    });
+
+    for(unsigned int t = 0; t < threadCount; t++) {
+        _size -= removed[t];
+    }
+    delete[] removed;
+}
+
+
+
 #endif // HASHSET_HPP
 
     
\ No newline at end of file
@@ -0,0 +1,125 @@
+// LengthPartitionedSet.cpp
+//
+// ICS 46 Spring 2018
+// Project #4: Set the Controls for the Heart of the Sun
+
+#include "LengthPartitionedSet.hpp"
+
+
+
+LengthPartitionedSet::LengthPartitionedSet(HashSet<std::string>::HashFunction hashFunction)
+    : hashFunction{hashFunction}, lengths{0, 0}, _size{0}
+{
+    for(unsigned int p = 0; p < PARTITION_COUNT; p++) {
+        partitions[p] = NULL;
+        for(std::uint64_t& bits : firsts[p]) {
+            bits = 0;
+        }
+    }
+}
+
+
+LengthPartitionedSet::~LengthPartitionedSet() noexcept
+{
+    for(HashSet<std::string>* partition : partitions) {
+        delete partition;
+    }
+}
+
+
+bool LengthPartitionedSet::isImplemented() const noexcept
+{
+    return true;
+}
+
+
+void LengthPartitionedSet::add(const std::string& element)
+{
+    if(contains(element)) {
+        return;
+    }
+
+    unsigned int p = partitionOf(element.size());
+    if(partitions[p] == NULL) {
+        partitions[p] = new HashSet<std::string>{hashFunction};
+    }
+    partitions[p]->add(element);
+
+    lengths[p / 64] |= std::uint64_t{1} << (p % 64);
+    if(!element.empty()) {
+        unsigned char first = static_cast<unsigned char>(element[0]);
+        firsts[p][first / 64] |= std::uint64_t{1} << (first % 64);
+    }
+
+    _size++;
+}
+
+
+bool LengthPartitionedSet::contains(const std::string& element) const
+{
+    if(!element.empty() && !hasShape(element.size(), element[0])) {
+        return false;
+    }
+
+    const HashSet<std::string>* partition = partitions[partitionOf(element.size())];
+    return partition != NULL && partition->contains(element);
+}
+
+
+void LengthPartitionedSet::containsMany(const std::string* elements, unsigned int count, bool* results) const
+{
+    unsigned int first = 0;
+    while(first < count) {
+        unsigned int p = partitionOf(elements[first].size());
+
+        unsigned int end = first + 1;
+        while(end < count && partitionOf(elements[end].size()) == p) {
+            end++;
+        }
+
+        if(partitions[p] == NULL) {
+            for(unsigned int i = first; i < end; i++) {
+                results[i] = false;
+            }
+        }
+        else {
+            partitions[p]->containsMany(elements + first, end - first, results + first);
+        }
+
+        first = end;
+    }
+}
+
+
+unsigned int LengthPartitionedSet::size() const noexcept
+{
+    return _size;
+}
+
+
+bool LengthPartitionedSet::hasLength(std::string::size_type length) const noexcept
+{
+    unsigned int p = partitionOf(length);
+    return (lengths[p / 64] >> (p % 64)) & 1;
+}
+
+
+bool LengthPartitionedSet::hasShape(std::string::size_type length, char first) const noexcept
+{
+    unsigned int p = partitionOf(length);
+    unsigned char c = static_cast<unsigned char>(first);
+    return (firsts[p][c / 64] >> (c % 64)) & 1;
+}
+
+
+unsigned int LengthPartitionedSet::sizeOfLength(std::string::size_type length) const noexcept
+{
+    const HashSet<std::string>* partition = partitions[partitionOf(length)];
+    return partition == NULL ? 0 : partition->size();
+}
+
+
+unsigned int LengthPartitionedSet::partitionOf(std::string::size_type length) noexcept
+{
+    return length <= MAX_LENGTH ? static_cast<unsigned int>(length) : MAX_LENGTH + 1;
+}
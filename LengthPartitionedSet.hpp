@@ -0,0 +1,117 @@
+// LengthPartitionedSet.hpp
+//
+// ICS 46 Spring 2018
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// A LengthPartitionedSet is a Set of words that keeps the words of each
+// length in a HashSet of their own.  Words longer than MAX_LENGTH share one
+// last partition.  Each partition is much smaller than a single table for
+// the whole dictionary would be, so the parts of it that lookups touch are
+// more likely to stay in the cache.
+//
+// Alongside the partitions, the set keeps an occupancy bitmap: one bit per
+// length, saying whether any word of that length exists, and for each
+// length one bit per first character.  Asking whether any word has a given
+// length and first character takes constant time and touches no partition,
+// which lets a WordChecker skip candidates (or whole techniques) that
+// can't possibly be words.  contains() consults the bitmap first, too.
+//
+// A LengthPartitionedSet can't be copied; the partitions are owned by the
+// set and are usually large.
+
+#ifndef LENGTHPARTITIONEDSET_HPP
+#define LENGTHPARTITIONEDSET_HPP
+
+#include <cstdint>
+#include <string>
+#include "HashSet.hpp"
+#include "Set.hpp"
+
+
+
+class LengthPartitionedSet : public Set<std::string>
+{
+public:
+    // Words of this many characters or fewer have a partition to
+    // themselves; longer words share the partition after it.
+    static constexpr unsigned int MAX_LENGTH = 63;
+
+public:
+    // Initializes a LengthPartitionedSet to be empty.  Every partition will
+    // use the given hash function.
+    explicit LengthPartitionedSet(HashSet<std::string>::HashFunction hashFunction);
+
+    // Cleans up the LengthPartitionedSet so that it leaks no memory.
+    virtual ~LengthPartitionedSet() noexcept;
+
+    LengthPartitionedSet(const LengthPartitionedSet& s) = delete;
+    LengthPartitionedSet& operator=(const LengthPartitionedSet& s) = delete;
+
+
+    // isImplemented() returns true, since a LengthPartitionedSet is
+    // implemented.
+    virtual bool isImplemented() const noexcept override;
+
+
+    // add() adds a word to the partition for its length, creating the
+    // partition if it's the first word of that length.  If the word is
+    // already in the set, this function has no effect.
+    virtual void add(const std::string& element) override;
+
+
+    // contains() returns true if the given word is in the set, false
+    // otherwise.  Words whose length and first character match no word in
+    // the set are turned away without a lookup.
+    virtual bool contains(const std::string& element) const override;
+
+
+    // containsMany() sets results[i] to contains(elements[i]) for each of
+    // the "count" elements.  Consecutive elements that belong to the same
+    // partition are handed to its HashSet's containsMany() together.
+    void containsMany(const std::string* elements, unsigned int count, bool* results) const;
+
+
+    // size() returns the number of words in the set.
+    virtual unsigned int size() const noexcept override;
+
+
+    // hasLength() returns true if the set may contain a word of the given
+    // length.  It's exact for lengths up to MAX_LENGTH; for longer lengths,
+    // it returns true if there are any words longer than MAX_LENGTH.
+    bool hasLength(std::string::size_type length) const noexcept;
+
+
+    // hasShape() returns true if the set may contain a word of the given
+    // length that begins with the given character, with the same caveat
+    // about lengths as hasLength().  It runs in constant time.
+    bool hasShape(std::string::size_type length, char first) const noexcept;
+
+
+    // sizeOfLength() returns the number of words of the given length (or,
+    // for lengths over MAX_LENGTH, the number of words over MAX_LENGTH).
+    unsigned int sizeOfLength(std::string::size_type length) const noexcept;
+
+
+private:
+    static constexpr unsigned int PARTITION_COUNT = MAX_LENGTH + 2;
+
+    HashSet<std::string>::HashFunction hashFunction;
+
+    // partitions[p] is NULL until a word is added to it
+    HashSet<std::string>* partitions[PARTITION_COUNT];
+
+    // bit p is set if partition p has any words
+    std::uint64_t lengths[2];
+
+    // bit c of firsts[p] is set if partition p has a word beginning with
+    // the character whose unsigned value is c
+    std::uint64_t firsts[PARTITION_COUNT][4];
+
+    unsigned int _size;
+
+    static unsigned int partitionOf(std::string::size_type length) noexcept;
+};
+
+
+
+#endif // LENGTHPARTITIONEDSET_HPP
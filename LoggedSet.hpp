@@ -0,0 +1,214 @@
+// LoggedSet.hpp
+//
+// ICS 46 Spring 2018
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// A LoggedSet is a Set of words whose additions survive a restart.  It
+// wraps a set it doesn't own (an AVLSet or a BPlusTreeSet: anything with
+// addAll() and inorder()) and keeps a WordLog for it.  Each add() of a new
+// word is appended to the log, and returns once the word is durable; when
+// the log grows past a threshold, the whole set is compacted into a new
+// snapshot and the log starts over.
+//
+// Constructing a LoggedSet recovers the set: the snapshot and the tail of
+// the log are each added with a single call to addAll(), so a restart
+// costs a bulk load rather than thousands of individual add()s.  On the
+// first run, when there's no snapshot yet, load the dictionary into the
+// set before constructing the LoggedSet; its contents then become the
+// first snapshot.  (WordLog::snapshotExists() says which case applies.)
+//
+// Any number of threads may call add() and contains() at once; add()s that
+// happen together share a single fdatasync() (see WordLog).  The set must
+// outlive the LoggedSet and must only be used through it.
+//
+// You are permitted to use the C++ Standard Library in this class.
+
+#ifndef LOGGEDSET_HPP
+#define LOGGEDSET_HPP
+
+#include <cstddef>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+#include "ParallelBuild.hpp"
+#include "Set.hpp"
+#include "WordLog.hpp"
+
+
+
+template <typename SetType>
+class LoggedSet : public Set<std::string>
+{
+public:
+    struct Options
+    {
+        // whether add() waits for each word to reach the disk
+        bool sync = true;
+
+        // the size the log can grow to before it's compacted into a new
+        // snapshot
+        std::size_t compactAfterBytes = 1024 * 1024;
+
+        // the number of threads used by addAll() during recovery
+        unsigned int threadCount = defaultThreadCount();
+    };
+
+public:
+    // Initializes a LoggedSet over the given set, whose files are named
+    // after the given path, recovering any words saved there into the set.
+    LoggedSet(SetType& words, const std::string& path);
+    LoggedSet(SetType& words, const std::string& path, Options options);
+
+    LoggedSet(const LoggedSet& s) = delete;
+    LoggedSet& operator=(const LoggedSet& s) = delete;
+
+
+    // isImplemented() returns true, since a LoggedSet is implemented.
+    virtual bool isImplemented() const noexcept override;
+
+
+    // add() adds a word to the set and the log, returning once it's
+    // durable.  If the word is already in the set, this function has no
+    // effect.  It throws a std::system_error if the word can't be logged,
+    // in which case it isn't added either.
+    virtual void add(const std::string& element) override;
+
+
+    // contains() returns true if the given word is in the set, false
+    // otherwise.
+    virtual bool contains(const std::string& element) const override;
+
+
+    // size() returns the number of words in the set.
+    virtual unsigned int size() const noexcept override;
+
+
+    // compact() writes the whole set to a new snapshot and empties the log.
+    // add() calls it when the log grows past the threshold; add()s that
+    // arrive while it runs wait for it to finish.
+    void compact();
+
+
+    // logBytes() returns the size of the log since the last compaction.
+    std::size_t logBytes() const;
+
+
+private:
+    SetType& words;
+    WordLog log;
+    std::size_t compactAfterBytes;
+
+    // held shared by contains() and exclusively while a word is added to
+    // the set
+    mutable std::shared_mutex wordsMutex;
+
+    // held shared by add() from the time it logs a word until the word is
+    // in the set, and exclusively by compact(), so a snapshot always holds
+    // every word that's been logged
+    std::shared_mutex compactionMutex;
+};
+
+
+
+template <typename SetType>
+LoggedSet<SetType>::LoggedSet(SetType& words, const std::string& path)
+    : LoggedSet{words, path, Options{}}
+{
+}
+
+
+template <typename SetType>
+LoggedSet<SetType>::LoggedSet(SetType& words, const std::string& path, Options options)
+    : words{words}, log{path, WordLog::Options{options.sync}}, compactAfterBytes{options.compactAfterBytes}
+{
+    bool firstRun = !WordLog::snapshotExists(path);
+
+    std::vector<std::string> snapshot;
+    std::vector<std::string> tail;
+    log.recover(snapshot, tail);
+
+    words.addAll(snapshot.data(), static_cast<unsigned int>(snapshot.size()), options.threadCount);
+    snapshot = std::vector<std::string>{};
+
+    words.addAll(tail.data(), static_cast<unsigned int>(tail.size()), options.threadCount);
+
+    if(firstRun) {
+        compact();
+    }
+}
+
+
+template <typename SetType>
+bool LoggedSet<SetType>::isImplemented() const noexcept
+{
+    return true;
+}
+
+
+template <typename SetType>
+void LoggedSet<SetType>::add(const std::string& element)
+{
+    if(contains(element)) {
+        return;
+    }
+
+    {
+        std::shared_lock<std::shared_mutex> compactionLock{compactionMutex};
+
+        // two threads adding the same word at once may both log it, which
+        // is harmless, since replaying it twice adds it once
+        log.append(element);
+
+        std::unique_lock<std::shared_mutex> wordsLock{wordsMutex};
+        if(!words.contains(element)) {
+            words.add(element);
+        }
+    }
+
+    if(log.logBytes() > compactAfterBytes) {
+        std::unique_lock<std::shared_mutex> compactionLock{compactionMutex, std::try_to_lock};
+
+        // if another thread is already compacting, there's nothing to do
+        if(compactionLock.owns_lock() && log.logBytes() > compactAfterBytes) {
+            std::shared_lock<std::shared_mutex> wordsLock{wordsMutex};
+            log.compact(words);
+        }
+    }
+}
+
+
+template <typename SetType>
+bool LoggedSet<SetType>::contains(const std::string& element) const
+{
+    std::shared_lock<std::shared_mutex> lock{wordsMutex};
+    return words.contains(element);
+}
+
+
+template <typename SetType>
+unsigned int LoggedSet<SetType>::size() const noexcept
+{
+    std::shared_lock<std::shared_mutex> lock{wordsMutex};
+    return words.size();
+}
+
+
+template <typename SetType>
+void LoggedSet<SetType>::compact()
+{
+    std::unique_lock<std::shared_mutex> compactionLock{compactionMutex};
+    std::shared_lock<std::shared_mutex> wordsLock{wordsMutex};
+    log.compact(words);
+}
+
+
+template <typename SetType>
+std::size_t LoggedSet<SetType>::logBytes() const
+{
+    return log.logBytes();
+}
+
+
+
+#endif // LOGGEDSET_HPP
@@ -0,0 +1,63 @@
+// MultiDictionaryChecker.cpp
+//
+// ICS 46 Spring 2018
+// Project #4: Set the Controls for the Heart of the Sun
+
+#include "MultiDictionaryChecker.hpp"
+#include "BasicWordChecker.hpp"
+
+#include <algorithm>
+#include <utility>
+
+
+
+MultiDictionaryChecker::MultiDictionaryChecker(const MultiDictionarySet& words)
+    : words{words}
+{
+}
+
+
+MultiDictionaryChecker::Mask MultiDictionaryChecker::wordExists(const std::string& word, Mask dictionaries) const
+{
+    return words.dictionariesOf(word) & dictionaries;
+}
+
+
+std::vector<MultiDictionaryChecker::Suggestion> MultiDictionaryChecker::findSuggestions(
+    const std::string& word, Mask dictionaries) const
+{
+    MultiDictionarySet::View view = words.view(dictionaries);
+
+    // the splits are found apart from the other suggestions, since their
+    // masks are found differently; they're found last either way, so the
+    // order doesn't change
+    std::vector<std::string> edits = BasicWordChecker<MultiDictionarySet::View, EditTechniques>{view}.findSuggestions(word);
+    std::vector<std::string> splits = BasicWordChecker<MultiDictionarySet::View, SplitTechniques>{view}.findSuggestions(word);
+
+    std::vector<Suggestion> suggestions;
+    suggestions.reserve(edits.size() + splits.size());
+
+    for(std::string& suggestion : edits) {
+        // a word found in the view is in at least one selected dictionary,
+        // even if it contains a space
+        Mask mask = words.dictionariesOf(suggestion) & dictionaries;
+        suggestions.push_back(Suggestion{std::move(suggestion), mask});
+    }
+
+    for(std::string& suggestion : splits) {
+        // the view only required each half to be in some selected
+        // dictionary; both have to be in the same one.  The space was
+        // inserted where the suggestion first differs from the word.
+        std::string::size_type space = std::mismatch(word.begin(), word.end(), suggestion.begin()).first - word.begin();
+
+        Mask mask = words.dictionariesOf(suggestion.substr(0, space))
+            & words.dictionariesOf(suggestion.substr(space + 1))
+            & dictionaries;
+
+        if(mask != 0) {
+            suggestions.push_back(Suggestion{std::move(suggestion), mask});
+        }
+    }
+
+    return suggestions;
+}
@@ -0,0 +1,71 @@
+// MultiDictionaryChecker.hpp
+//
+// ICS 46 Spring 2018
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// A MultiDictionaryChecker checks words against any combination of the
+// dictionaries in a MultiDictionarySet, chosen by a mask on each call, and
+// says which of them each word (or suggestion) came from.  Rather than one
+// WordChecker per dictionary, each looking up every candidate again, it
+// looks up each candidate once: the suggestions come from a
+// BasicWordChecker over a View of the selected dictionaries, and only the
+// few suggestions it finds are looked up again for their masks.
+//
+// A plain WordChecker (or BasicWordChecker) over a View doesn't do that
+// last step, so it still suggests splits whose halves are only found in
+// different dictionaries; a MultiDictionaryChecker doesn't.
+//
+// You are permitted to use the C++ Standard Library in this class.
+
+#ifndef MULTIDICTIONARYCHECKER_HPP
+#define MULTIDICTIONARYCHECKER_HPP
+
+#include <string>
+#include <vector>
+#include "MultiDictionarySet.hpp"
+
+
+
+class MultiDictionaryChecker
+{
+public:
+    using Mask = MultiDictionarySet::Mask;
+
+    // A Suggestion is a suggested spelling along with the selected
+    // dictionaries it came from.  For a suggestion made by splitting the
+    // word in two, those are the dictionaries that contain both of its
+    // words, so a split whose words are only found in different
+    // dictionaries (such as "HAUS DOG") isn't suggested.  Any other
+    // suggestion is a word in the dictionaries, even one that contains a
+    // space, and its mask is that word's own.
+    struct Suggestion
+    {
+        std::string word;
+        Mask dictionaries;
+    };
+
+public:
+    // Initializes a MultiDictionaryChecker that uses the given set, which
+    // must outlive it.
+    explicit MultiDictionaryChecker(const MultiDictionarySet& words);
+
+
+    // wordExists() returns the mask of the selected dictionaries that
+    // contain the given word, which is 0 if it's misspelled in all of them.
+    Mask wordExists(const std::string& word, Mask dictionaries) const;
+
+
+    // findSuggestions() returns the suggestions that a WordChecker would
+    // find for the given word in any one of the selected dictionaries, each
+    // with its mask, in the order that a WordChecker would find them in all
+    // of the selected dictionaries taken together.
+    std::vector<Suggestion> findSuggestions(const std::string& word, Mask dictionaries) const;
+
+
+private:
+    const MultiDictionarySet& words;
+};
+
+
+
+#endif // MULTIDICTIONARYCHECKER_HPP
@@ -0,0 +1,262 @@
+// MultiDictionarySet.cpp
+//
+// ICS 46 Spring 2018
+// Project #4: Set the Controls for the Heart of the Sun
+
+#include "MultiDictionarySet.hpp"
+
+#include <stdexcept>
+
+
+
+namespace
+{
+    unsigned int countBits(MultiDictionarySet::Mask mask) noexcept
+    {
+        unsigned int bits = 0;
+        for(; mask != 0; mask &= mask - 1) {
+            bits++;
+        }
+        return bits;
+    }
+}
+
+
+
+MultiDictionarySet::MultiDictionarySet(HashSet<std::string>::HashFunction hashFunction)
+    : hashFunction{hashFunction}, array{new Node*[DEFAULT_CAPACITY]}, capacity{DEFAULT_CAPACITY}, _size{0}
+{
+    for(unsigned int i = 0; i < capacity; i++) {
+        array[i] = NULL;
+    }
+    for(unsigned int& count : counts) {
+        count = 0;
+    }
+}
+
+
+MultiDictionarySet::~MultiDictionarySet() noexcept
+{
+    for(unsigned int i = 0; i < capacity; i++) {
+        Node* workingNode = array[i];
+        while(workingNode != NULL) {
+            Node* next = workingNode->next;
+            delete workingNode;
+            workingNode = next;
+        }
+    }
+    delete[] array;
+}
+
+
+bool MultiDictionarySet::isImplemented() const noexcept
+{
+    return true;
+}
+
+
+void MultiDictionarySet::add(const std::string& element)
+{
+    add(element, 0);
+}
+
+
+void MultiDictionarySet::add(const std::string& word, unsigned int dictionary)
+{
+    if(dictionary >= MAX_DICTIONARIES) {
+        throw std::out_of_range{"MultiDictionarySet: no such dictionary"};
+    }
+
+    Mask bit = Mask{1} << dictionary;
+
+    Node* node = find(word);
+    if(node != NULL) {
+        if((node->dictionaries & bit) == 0) {
+            node->dictionaries |= bit;
+            counts[dictionary]++;
+        }
+        return;
+    }
+
+    if(static_cast<double>(_size) / capacity > 0.8) {
+        rehash(2 * capacity);
+    }
+
+    unsigned int index = hashFunction(word) % capacity;
+    array[index] = new Node{word, bit, array[index]};
+    _size++;
+    counts[dictionary]++;
+}
+
+
+bool MultiDictionarySet::contains(const std::string& element) const
+{
+    return find(element) != NULL;
+}
+
+
+MultiDictionarySet::Mask MultiDictionarySet::dictionariesOf(const std::string& word) const
+{
+    Node* node = find(word);
+    return node != NULL ? node->dictionaries : 0;
+}
+
+
+void MultiDictionarySet::dictionariesOfMany(const std::string* words, unsigned int count, Mask* results) const
+{
+    unsigned int indexes[LOOKUP_GROUP_SIZE];
+    Node* heads[LOOKUP_GROUP_SIZE];
+
+    for(unsigned int first = 0; first < count; first += LOOKUP_GROUP_SIZE) {
+        unsigned int groupSize = count - first < LOOKUP_GROUP_SIZE ? count - first : LOOKUP_GROUP_SIZE;
+
+        for(unsigned int i = 0; i < groupSize; i++) {
+            indexes[i] = hashFunction(words[first + i]) % capacity;
+#if defined(__GNUC__)
+            __builtin_prefetch(array + indexes[i]);
+#endif
+        }
+
+        for(unsigned int i = 0; i < groupSize; i++) {
+            heads[i] = array[indexes[i]];
+#if defined(__GNUC__)
+            if(heads[i] != NULL) {
+                __builtin_prefetch(heads[i]);
+            }
+#endif
+        }
+
+        for(unsigned int i = 0; i < groupSize; i++) {
+            Mask found = 0;
+            for(Node* workingNode = heads[i]; workingNode != NULL; workingNode = workingNode->next) {
+                if(workingNode->word == words[first + i]) {
+                    found = workingNode->dictionaries;
+                    break;
+                }
+            }
+            results[first + i] = found;
+        }
+    }
+}
+
+
+unsigned int MultiDictionarySet::size() const noexcept
+{
+    return _size;
+}
+
+
+unsigned int MultiDictionarySet::sizeOf(Mask dictionaries) const noexcept
+{
+    if(countBits(dictionaries) == 1) {
+        unsigned int dictionary = 0;
+        while((dictionaries & (Mask{1} << dictionary)) == 0) {
+            dictionary++;
+        }
+        return counts[dictionary];
+    }
+
+    unsigned int words = 0;
+    for(unsigned int i = 0; i < capacity; i++) {
+        for(Node* workingNode = array[i]; workingNode != NULL; workingNode = workingNode->next) {
+            if((workingNode->dictionaries & dictionaries) != 0) {
+                words++;
+            }
+        }
+    }
+    return words;
+}
+
+
+MultiDictionarySet::View MultiDictionarySet::view(Mask dictionaries) const
+{
+    return View{*this, dictionaries};
+}
+
+
+MultiDictionarySet::Node* MultiDictionarySet::find(const std::string& word) const
+{
+    for(Node* workingNode = array[hashFunction(word) % capacity]; workingNode != NULL; workingNode = workingNode->next) {
+        if(workingNode->word == word) {
+            return workingNode;
+        }
+    }
+    return NULL;
+}
+
+
+void MultiDictionarySet::rehash(unsigned int newCapacity)
+{
+    Node** newArray = new Node*[newCapacity];
+    for(unsigned int i = 0; i < newCapacity; i++) {
+        newArray[i] = NULL;
+    }
+
+    // relink the existing nodes rather than copying them
+    for(unsigned int i = 0; i < capacity; i++) {
+        Node* workingNode = array[i];
+        while(workingNode != NULL) {
+            Node* next = workingNode->next;
+            unsigned int index = hashFunction(workingNode->word) % newCapacity;
+            workingNode->next = newArray[index];
+            newArray[index] = workingNode;
+            workingNode = next;
+        }
+    }
+
+    delete[] array;
+    array = newArray;
+    capacity = newCapacity;
+}
+
+
+
+MultiDictionarySet::View::View(const MultiDictionarySet& set, Mask dictionaries)
+    : set{set}, mask{dictionaries}
+{
+}
+
+
+bool MultiDictionarySet::View::isImplemented() const noexcept
+{
+    return true;
+}
+
+
+void MultiDictionarySet::View::add(const std::string&)
+{
+    throw std::logic_error{"MultiDictionarySet::View is read-only"};
+}
+
+
+bool MultiDictionarySet::View::contains(const std::string& element) const
+{
+    return (set.dictionariesOf(element) & mask) != 0;
+}
+
+
+void MultiDictionarySet::View::containsMany(const std::string* elements, unsigned int count, bool* results) const
+{
+    Mask found[LOOKUP_GROUP_SIZE];
+
+    for(unsigned int first = 0; first < count; first += LOOKUP_GROUP_SIZE) {
+        unsigned int groupSize = count - first < LOOKUP_GROUP_SIZE ? count - first : LOOKUP_GROUP_SIZE;
+
+        set.dictionariesOfMany(elements + first, groupSize, found);
+        for(unsigned int i = 0; i < groupSize; i++) {
+            results[first + i] = (found[i] & mask) != 0;
+        }
+    }
+}
+
+
+unsigned int MultiDictionarySet::View::size() const noexcept
+{
+    return set.sizeOf(mask);
+}
+
+
+MultiDictionarySet::Mask MultiDictionarySet::View::dictionaries() const noexcept
+{
+    return mask;
+}
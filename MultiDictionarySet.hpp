@@ -0,0 +1,199 @@
+// MultiDictionarySet.hpp
+//
+// ICS 46 Spring 2018
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// A MultiDictionarySet holds the words of up to MAX_DICTIONARIES
+// dictionaries (say, one per language, plus a few glossaries) in a single
+// separately-chained hash table.  Each distinct word is stored once, along
+// with a bitmask saying which dictionaries contain it: bit d is set if
+// dictionary d does.  One lookup answers for every dictionary at once, so
+// checking a word against eight dictionaries costs what checking it
+// against one would, and the memory grows with the number of distinct
+// words rather than with the total size of the dictionaries.
+//
+// A View is a Set of the words in some of the dictionaries -- those whose
+// bits are set in a mask -- so it can be given to a WordChecker, which will
+// find suggestions from the selected dictionaries with one lookup per
+// candidate.  A MultiDictionaryChecker does the same and also reports which
+// dictionaries each word came from.
+//
+// As with the HashSet, the table doubles in size whenever there are more
+// than 80% as many words as there are buckets.  A MultiDictionarySet can't
+// be copied.
+
+#ifndef MULTIDICTIONARYSET_HPP
+#define MULTIDICTIONARYSET_HPP
+
+#include <cstdint>
+#include <string>
+#include "HashSet.hpp"
+#include "Set.hpp"
+
+
+
+class MultiDictionarySet : public Set<std::string>
+{
+public:
+    // A Mask selects dictionaries: bit d stands for dictionary d.
+    using Mask = std::uint32_t;
+
+    // The number of dictionaries a MultiDictionarySet can hold.
+    static constexpr unsigned int MAX_DICTIONARIES = 32;
+
+    // A Mask that selects every dictionary.
+    static constexpr Mask ALL_DICTIONARIES = 0xFFFFFFFFu;
+
+    // The capacity of the table before anything has been added to it.
+    static constexpr unsigned int DEFAULT_CAPACITY = 10;
+
+    // dictionariesOfMany() looks up words in groups of this many.
+    static constexpr unsigned int LOOKUP_GROUP_SIZE = 16;
+
+    class View;
+
+public:
+    // Initializes a MultiDictionarySet with no words in any dictionary,
+    // which will hash words with the given hash function.
+    explicit MultiDictionarySet(HashSet<std::string>::HashFunction hashFunction);
+
+    // Cleans up the MultiDictionarySet so that it leaks no memory.
+    virtual ~MultiDictionarySet() noexcept;
+
+    MultiDictionarySet(const MultiDictionarySet& s) = delete;
+    MultiDictionarySet& operator=(const MultiDictionarySet& s) = delete;
+
+
+    // isImplemented() returns true, since a MultiDictionarySet is
+    // implemented.
+    virtual bool isImplemented() const noexcept override;
+
+
+    // add() adds a word to dictionary 0.
+    virtual void add(const std::string& element) override;
+
+
+    // This version of add() adds a word to the given dictionary.  If the
+    // word is already in another dictionary, it isn't stored again; its
+    // bitmask gains the dictionary's bit.  It throws a std::out_of_range if
+    // the dictionary is MAX_DICTIONARIES or more.
+    void add(const std::string& word, unsigned int dictionary);
+
+
+    // addAll() adds every element of an ordered set (such as an AVLSet) to
+    // the given dictionary.
+    template <typename OrderedSet>
+    void addAll(const OrderedSet& words, unsigned int dictionary);
+
+
+    // contains() returns true if the given word is in any dictionary,
+    // false otherwise.
+    virtual bool contains(const std::string& element) const override;
+
+
+    // dictionariesOf() returns the bitmask of the dictionaries that contain
+    // the given word, or 0 if none do, with one lookup.
+    Mask dictionariesOf(const std::string& word) const;
+
+
+    // dictionariesOfMany() sets results[i] to dictionariesOf(words[i]) for
+    // each of the "count" words.  Like HashSet::containsMany(), it works on
+    // LOOKUP_GROUP_SIZE words at a time, prefetching their buckets and then
+    // the first node of each chain before comparing any words.
+    void dictionariesOfMany(const std::string* words, unsigned int count, Mask* results) const;
+
+
+    // size() returns the number of distinct words in all of the
+    // dictionaries together.
+    virtual unsigned int size() const noexcept override;
+
+
+    // sizeOf() returns the number of words in any of the selected
+    // dictionaries.  It runs in constant time when the mask selects a
+    // single dictionary, and in O(n) time for n distinct words otherwise.
+    unsigned int sizeOf(Mask dictionaries) const noexcept;
+
+
+    // view() returns a View of the selected dictionaries.  The View refers
+    // to this set, which must outlive it.
+    View view(Mask dictionaries) const;
+
+
+private:
+    HashSet<std::string>::HashFunction hashFunction;
+
+    struct Node
+    {
+        std::string word;
+        Mask dictionaries;
+        Node* next;
+    };
+
+    Node** array;
+    unsigned int capacity;
+    unsigned int _size;
+
+    // the number of words in each dictionary
+    unsigned int counts[MAX_DICTIONARIES];
+
+    Node* find(const std::string& word) const;
+
+    // moves every node into a new array with the given capacity
+    void rehash(unsigned int newCapacity);
+};
+
+
+
+// A View is a Set of the words in the dictionaries selected by its mask.
+// Its contains() makes one lookup, however many dictionaries are selected.
+// It's read-only: add() throws a std::logic_error.
+class MultiDictionarySet::View : public Set<std::string>
+{
+public:
+    View(const MultiDictionarySet& set, Mask dictionaries);
+
+
+    // isImplemented() returns true, since a View is implemented.
+    virtual bool isImplemented() const noexcept override;
+
+
+    // add() throws a std::logic_error, since a View can't be changed; add
+    // words to the MultiDictionarySet instead.
+    virtual void add(const std::string& element) override;
+
+
+    // contains() returns true if the given word is in any of the selected
+    // dictionaries, false otherwise.
+    virtual bool contains(const std::string& element) const override;
+
+
+    // containsMany() sets results[i] to contains(elements[i]) for each of
+    // the "count" elements, using the set's dictionariesOfMany().
+    void containsMany(const std::string* elements, unsigned int count, bool* results) const;
+
+
+    // size() returns the number of words in any of the selected
+    // dictionaries, as MultiDictionarySet::sizeOf() does.
+    virtual unsigned int size() const noexcept override;
+
+
+    // dictionaries() returns the mask that selects the View's dictionaries.
+    Mask dictionaries() const noexcept;
+
+
+private:
+    const MultiDictionarySet& set;
+    Mask mask;
+};
+
+
+
+template <typename OrderedSet>
+void MultiDictionarySet::addAll(const OrderedSet& words, unsigned int dictionary)
+{
+    words.inorder([&](const std::string& word) { add(word, dictionary); });
+}
+
+
+
+#endif // MULTIDICTIONARYSET_HPP
@@ -0,0 +1,292 @@
+// NumaMemory.cpp
+//
+// ICS 46 Spring 2018
+// Project #4: Set the Controls for the Heart of the Sun
+
+#include "NumaMemory.hpp"
+
+#include <cstdint>
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+
+namespace
+{
+    // the mbind() policy that prefers a node but falls back to others when
+    // it's full; it's defined here so that <numaif.h> (part of libnuma)
+    // isn't needed
+    constexpr int MPOL_PREFERRED_POLICY = 1;
+
+    // the most nodes that a node mask passed to mbind() can name
+    constexpr unsigned int MAX_NODES = 1024;
+
+
+    // parseList() parses a list in the form the kernel uses in /sys, such as
+    // "0-3,8,10-11", into the numbers it names.
+    std::vector<unsigned int> parseList(const std::string& text)
+    {
+        std::vector<unsigned int> numbers;
+        std::istringstream in{text};
+        std::string range;
+
+        while(std::getline(in, range, ',')) {
+            if(range.empty() || range[0] < '0' || range[0] > '9') {
+                continue;
+            }
+
+            std::string::size_type dash = range.find('-');
+            unsigned long first = std::stoul(range.substr(0, dash));
+            unsigned long last = dash == std::string::npos ? first : std::stoul(range.substr(dash + 1));
+
+            for(unsigned long n = first; n <= last; n++) {
+                numbers.push_back(static_cast<unsigned int>(n));
+            }
+        }
+
+        return numbers;
+    }
+
+
+    // readList() reads and parses a list from a file in /sys, returning no
+    // numbers if the file doesn't exist.
+    std::vector<unsigned int> readList(const std::string& path)
+    {
+        std::ifstream file{path};
+        std::string text;
+        if(!file || !std::getline(file, text)) {
+            return {};
+        }
+        return parseList(text);
+    }
+
+
+    std::size_t roundUp(std::size_t bytes, std::size_t multiple) noexcept
+    {
+        if(bytes == 0) {
+            return multiple;
+        }
+        return (bytes + multiple - 1) / multiple * multiple;
+    }
+}
+
+
+
+unsigned int numaNodeCount()
+{
+    std::vector<unsigned int> nodes = readList("/sys/devices/system/node/online");
+
+    unsigned int count = 1;
+    for(unsigned int node : nodes) {
+        if(node + 1 > count) {
+            count = node + 1;
+        }
+    }
+    return count;
+}
+
+
+std::vector<unsigned int> cpusOfNode(unsigned int node)
+{
+    std::vector<unsigned int> cpus = readList("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+
+    if(cpus.empty() && numaNodeCount() == 1) {
+        unsigned int count = std::thread::hardware_concurrency();
+        for(unsigned int cpu = 0; cpu < (count == 0 ? 1 : count); cpu++) {
+            cpus.push_back(cpu);
+        }
+    }
+
+    return cpus;
+}
+
+
+unsigned int currentNumaNode() noexcept
+{
+#if defined(__linux__) && defined(SYS_getcpu)
+    unsigned int cpu = 0;
+    unsigned int node = 0;
+    if(syscall(SYS_getcpu, &cpu, &node, NULL) == 0) {
+        return node;
+    }
+#endif
+    return 0;
+}
+
+
+int currentCpu() noexcept
+{
+#if defined(__linux__)
+    return sched_getcpu();
+#else
+    return -1;
+#endif
+}
+
+
+bool pinToNode(unsigned int node) noexcept
+{
+#if defined(__linux__)
+    try {
+        std::vector<unsigned int> cpus = cpusOfNode(node);
+        if(cpus.empty()) {
+            return false;
+        }
+
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for(unsigned int cpu : cpus) {
+            if(cpu < CPU_SETSIZE) {
+                CPU_SET(cpu, &set);
+            }
+        }
+
+        return sched_setaffinity(0, sizeof(set), &set) == 0;
+    }
+    catch(...) {
+        return false;
+    }
+#else
+    return node == 0;
+#endif
+}
+
+
+
+HugePageRegion::HugePageRegion(std::size_t bytes, bool hugePages, int node)
+    : memory{NULL}, bytes{roundUp(bytes, HUGE_PAGE_SIZE)}, mapping{NULL}, mappingBytes{0},
+      kind{Backing::NORMAL}, boundNode{ANY_NODE}
+{
+#if defined(__linux__)
+    if(hugePages) {
+        void* p = mmap(NULL, this->bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if(p != MAP_FAILED) {
+            memory = mapping = p;
+            mappingBytes = this->bytes;
+            kind = Backing::HUGETLB;
+        }
+    }
+
+    if(memory == NULL) {
+        // transparent huge pages can only back 2 MB pieces that are aligned
+        // to 2 MB, so a little extra is mapped to be able to align it
+        mappingBytes = hugePages ? this->bytes + HUGE_PAGE_SIZE : this->bytes;
+        void* p = mmap(NULL, mappingBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if(p == MAP_FAILED) {
+            throw std::bad_alloc{};
+        }
+        mapping = p;
+
+        std::uintptr_t address = reinterpret_cast<std::uintptr_t>(p);
+        if(hugePages) {
+            address = roundUp(address, HUGE_PAGE_SIZE);
+        }
+        memory = reinterpret_cast<void*>(address);
+
+#if defined(MADV_HUGEPAGE)
+        if(hugePages && madvise(memory, this->bytes, MADV_HUGEPAGE) == 0) {
+            kind = Backing::TRANSPARENT;
+        }
+#endif
+    }
+
+#if defined(SYS_mbind)
+    if(node >= 0 && static_cast<unsigned int>(node) < MAX_NODES) {
+        unsigned long mask[MAX_NODES / (8 * sizeof(unsigned long))] = {};
+        mask[node / (8 * sizeof(unsigned long))] = 1UL << (node % (8 * sizeof(unsigned long)));
+
+        // the kernel counts one fewer node than it's told, so one more is
+        // passed, as libnuma does
+        if(syscall(SYS_mbind, memory, this->bytes, MPOL_PREFERRED_POLICY, mask, MAX_NODES + 1, 0) == 0) {
+            boundNode = node;
+        }
+    }
+#endif
+#else
+    (void)hugePages;
+    (void)node;
+    memory = mapping = new char[this->bytes]();
+    mappingBytes = this->bytes;
+#endif
+}
+
+
+HugePageRegion::~HugePageRegion() noexcept
+{
+    release();
+}
+
+
+HugePageRegion::HugePageRegion(HugePageRegion&& r) noexcept
+    : memory{r.memory}, bytes{r.bytes}, mapping{r.mapping}, mappingBytes{r.mappingBytes},
+      kind{r.kind}, boundNode{r.boundNode}
+{
+    r.memory = NULL;
+    r.mapping = NULL;
+    r.bytes = 0;
+    r.mappingBytes = 0;
+}
+
+
+HugePageRegion& HugePageRegion::operator=(HugePageRegion&& r) noexcept
+{
+    std::swap(memory, r.memory);
+    std::swap(bytes, r.bytes);
+    std::swap(mapping, r.mapping);
+    std::swap(mappingBytes, r.mappingBytes);
+    std::swap(kind, r.kind);
+    std::swap(boundNode, r.boundNode);
+    return *this;
+}
+
+
+void* HugePageRegion::data() const noexcept
+{
+    return memory;
+}
+
+
+std::size_t HugePageRegion::size() const noexcept
+{
+    return bytes;
+}
+
+
+HugePageRegion::Backing HugePageRegion::backing() const noexcept
+{
+    return kind;
+}
+
+
+int HugePageRegion::node() const noexcept
+{
+    return boundNode;
+}
+
+
+void HugePageRegion::release() noexcept
+{
+    if(mapping == NULL) {
+        return;
+    }
+
+#if defined(__linux__)
+    munmap(mapping, mappingBytes);
+#else
+    delete[] static_cast<char*>(mapping);
+#endif
+
+    memory = NULL;
+    mapping = NULL;
+}
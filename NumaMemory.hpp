@@ -0,0 +1,128 @@
+// NumaMemory.hpp
+//
+// ICS 46 Spring 2018
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// Utilities for placing read-mostly dictionary storage well in memory on
+// machines with more than one NUMA node (typically, one per socket), where
+// memory attached to another socket takes about twice as long to reach:
+// finding out how many nodes there are and which CPUs belong to each,
+// which node the calling thread is running on, pinning a thread to a node,
+// and allocating memory that is backed by 2 MB huge pages and placed on a
+// chosen node.  Huge pages cover a large table with far fewer TLB entries
+// than 4 KB pages do, so random lookups miss the TLB much less often.
+//
+// These talk to Linux directly -- /sys for the topology and the getcpu,
+// mbind and sched_setaffinity system calls -- rather than through libnuma,
+// so nothing extra needs to be installed.  Elsewhere, they act as if the
+// machine had one node and allocate ordinary memory.
+//
+// You are permitted to use the C++ Standard Library in these utilities.
+
+#ifndef NUMAMEMORY_HPP
+#define NUMAMEMORY_HPP
+
+#include <cstddef>
+#include <vector>
+
+
+
+// numaNodeCount() returns the number of NUMA nodes that have memory, which
+// is 1 on a machine (or system) that doesn't have more than one.
+unsigned int numaNodeCount();
+
+
+// cpusOfNode() returns the numbers of the CPUs that belong to the given
+// NUMA node.  On a machine with one node, that's every CPU.
+std::vector<unsigned int> cpusOfNode(unsigned int node);
+
+
+// currentNumaNode() returns the NUMA node of the CPU that the calling
+// thread is running on right now (which can change unless the thread is
+// pinned), or 0 if it can't be determined.
+unsigned int currentNumaNode() noexcept;
+
+
+// currentCpu() returns the CPU that the calling thread is running on right
+// now, or -1 if it can't be determined.  Unlike currentNumaNode(), it
+// doesn't make a system call on recent Linux systems, so it's cheap enough
+// to call for every lookup; cpusOfNode() maps CPUs to nodes.
+int currentCpu() noexcept;
+
+
+// pinToNode() restricts the calling thread to the CPUs of the given NUMA
+// node, returning true if that succeeded.
+bool pinToNode(unsigned int node) noexcept;
+
+
+
+// A HugePageRegion is a block of memory that is, if possible, backed by
+// 2 MB huge pages and placed on a chosen NUMA node.  It tries, in order:
+// explicit huge pages (MAP_HUGETLB, which needs pages reserved through
+// /proc/sys/vm/nr_hugepages), then ordinary memory aligned to 2 MB that
+// is marked with madvise(MADV_HUGEPAGE) so that the kernel backs it with
+// transparent huge pages when it can, and finally ordinary memory.  The
+// size is rounded up to a multiple of 2 MB.  The memory starts out zeroed.
+//
+// The node is set with mbind() before the memory is touched, so the pages
+// are allocated there whichever thread touches them first.
+class HugePageRegion
+{
+public:
+    enum class Backing
+    {
+        HUGETLB,
+        TRANSPARENT,
+        NORMAL
+    };
+
+    static constexpr std::size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+    // Passed as the node, this leaves the placement to the kernel.
+    static constexpr int ANY_NODE = -1;
+
+public:
+    // Allocates a region of at least the given number of bytes.  If
+    // "hugePages" is false, it goes straight to ordinary memory.  It throws
+    // a std::bad_alloc if no memory can be had at all.
+    explicit HugePageRegion(std::size_t bytes, bool hugePages = true, int node = ANY_NODE);
+
+    ~HugePageRegion() noexcept;
+
+    HugePageRegion(const HugePageRegion& r) = delete;
+    HugePageRegion& operator=(const HugePageRegion& r) = delete;
+
+    HugePageRegion(HugePageRegion&& r) noexcept;
+    HugePageRegion& operator=(HugePageRegion&& r) noexcept;
+
+
+    void* data() const noexcept;
+    std::size_t size() const noexcept;
+
+    // backing() returns what the region was allocated as.  TRANSPARENT
+    // means that huge pages were asked for; whether the kernel provided
+    // them depends on how much memory it could find in 2 MB pieces.
+    Backing backing() const noexcept;
+
+    // node() returns the node the region was bound to, or ANY_NODE.
+    int node() const noexcept;
+
+
+private:
+    void* memory;
+    std::size_t bytes;
+
+    // what was actually mapped, which can be larger than "bytes" so that
+    // the region could be aligned
+    void* mapping;
+    std::size_t mappingBytes;
+
+    Backing kind;
+    int boundNode;
+
+    void release() noexcept;
+};
+
+
+
+#endif // NUMAMEMORY_HPP
@@ -0,0 +1,202 @@
+// OverlaySet.hpp
+//
+// ICS 46 Spring 2018
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// An OverlaySet is a Set that layers a small, mutable set of its own over
+// a shared base Set that it never changes.  It contains every element of
+// the base plus every element added to it, so many OverlaySets -- one per
+// user, say, each with a few hundred custom words -- can share a single
+// large dictionary, and each one costs memory only for its own additions.
+// Since an OverlaySet is a Set, it can be handed to a WordChecker like any
+// other.
+//
+// The base is held by reference, so it has to outlive every OverlaySet
+// layered over it, and it must not be changed while they're in use.
+//
+// Added elements are kept in an AVLSet, and a small Bloom filter sits in
+// front of it: a lookup for an element that was never added (which is
+// nearly every lookup) is almost always turned away by checking two bits,
+// and goes straight to the base.
+
+#ifndef OVERLAYSET_HPP
+#define OVERLAYSET_HPP
+
+#include <cstdint>
+#include <functional>
+#include "AVLSet.hpp"
+#include "Set.hpp"
+
+
+
+template <typename ElementType>
+class OverlaySet : public Set<ElementType>
+{
+public:
+    // The number of bits in the filter in front of the added elements.  With
+    // a few hundred additions, the filter lets through only a few percent of
+    // the lookups for elements that were never added.
+    static constexpr unsigned int FILTER_BITS = 4096;
+
+public:
+    // Initializes an OverlaySet with nothing added to it, layered over the
+    // given base.
+    explicit OverlaySet(const Set<ElementType>& base);
+
+    // Cleans up the OverlaySet.  The base is left untouched.
+    virtual ~OverlaySet() noexcept = default;
+
+    // Initializes a new OverlaySet to be a copy of an existing one, layered
+    // over the same base.
+    OverlaySet(const OverlaySet& s) = default;
+
+    // Initializes a new OverlaySet whose additions are moved from an
+    // expiring one, layered over the same base.
+    OverlaySet(OverlaySet&& s) = default;
+
+
+    // isImplemented() returns true, since an OverlaySet is implemented.
+    virtual bool isImplemented() const noexcept override;
+
+
+    // add() adds an element to the overlay.  If the element is already in
+    // the base or the overlay, this function has no effect.
+    virtual void add(const ElementType& element) override;
+
+
+    // contains() returns true if the given element is in the base or has
+    // been added to the overlay, false otherwise.
+    virtual bool contains(const ElementType& element) const override;
+
+
+    // size() returns the number of elements in the base plus the number of
+    // elements added to the overlay.
+    virtual unsigned int size() const noexcept override;
+
+
+    // addedCount() returns the number of elements added to the overlay.
+    unsigned int addedCount() const noexcept;
+
+
+    // base() returns the set that the overlay is layered over.
+    const Set<ElementType>& base() const noexcept;
+
+
+    // added() returns the set of elements added to the overlay, so that
+    // they can be listed (e.g., to save them).
+    const AVLSet<ElementType>& added() const noexcept;
+
+
+private:
+    const Set<ElementType>* baseSet;
+    AVLSet<ElementType> overlay;
+    unsigned int overlaySize;
+
+    std::uint64_t filter[FILTER_BITS / 64];
+
+    // sets "first" and "second" to the two filter bits for an element
+    static void filterBits(const ElementType& element, unsigned int& first, unsigned int& second);
+
+    bool mayHaveAdded(const ElementType& element) const noexcept;
+};
+
+
+
+template <typename ElementType>
+OverlaySet<ElementType>::OverlaySet(const Set<ElementType>& base)
+    : baseSet{&base}, overlaySize{0}
+{
+    for(std::uint64_t& word : filter) {
+        word = 0;
+    }
+}
+
+
+template <typename ElementType>
+bool OverlaySet<ElementType>::isImplemented() const noexcept
+{
+    return true;
+}
+
+
+template <typename ElementType>
+void OverlaySet<ElementType>::add(const ElementType& element)
+{
+    if(contains(element)) {
+        return;
+    }
+
+    overlay.add(element);
+    overlaySize++;
+
+    unsigned int first, second;
+    filterBits(element, first, second);
+    filter[first / 64] |= std::uint64_t{1} << (first % 64);
+    filter[second / 64] |= std::uint64_t{1} << (second % 64);
+}
+
+
+template <typename ElementType>
+bool OverlaySet<ElementType>::contains(const ElementType& element) const
+{
+    if(mayHaveAdded(element) && overlay.contains(element)) {
+        return true;
+    }
+    return baseSet->contains(element);
+}
+
+
+template <typename ElementType>
+unsigned int OverlaySet<ElementType>::size() const noexcept
+{
+    return baseSet->size() + overlaySize;
+}
+
+
+template <typename ElementType>
+unsigned int OverlaySet<ElementType>::addedCount() const noexcept
+{
+    return overlaySize;
+}
+
+
+template <typename ElementType>
+const Set<ElementType>& OverlaySet<ElementType>::base() const noexcept
+{
+    return *baseSet;
+}
+
+
+template <typename ElementType>
+const AVLSet<ElementType>& OverlaySet<ElementType>::added() const noexcept
+{
+    return overlay;
+}
+
+
+template <typename ElementType>
+void OverlaySet<ElementType>::filterBits(const ElementType& element, unsigned int& first, unsigned int& second)
+{
+    std::uint64_t hash = static_cast<std::uint64_t>(std::hash<ElementType>{}(element));
+    hash *= 0x9E3779B97F4A7C15ULL;
+
+    first = static_cast<unsigned int>(hash >> 52) % FILTER_BITS;
+    second = static_cast<unsigned int>(hash >> 20) % FILTER_BITS;
+}
+
+
+template <typename ElementType>
+bool OverlaySet<ElementType>::mayHaveAdded(const ElementType& element) const noexcept
+{
+    if(overlaySize == 0) {
+        return false;
+    }
+
+    unsigned int first, second;
+    filterBits(element, first, second);
+    return (filter[first / 64] >> (first % 64)) & (filter[second / 64] >> (second % 64)) & 1;
+}
+
+
+
+#endif // OVERLAYSET_HPP
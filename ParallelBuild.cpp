@@ -0,0 +1,95 @@
+// ParallelBuild.cpp
+//
+// ICS 46 Spring 2018
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// Implementations of the parallel building utilities that aren't
+// templates.
+
+#include "ParallelBuild.hpp"
+
+#include <fstream>
+#include <iterator>
+
+
+
+unsigned int defaultThreadCount() noexcept
+{
+    unsigned int count = std::thread::hardware_concurrency();
+    return count == 0 ? 1 : count;
+}
+
+
+void chunkBounds(unsigned int count, unsigned int chunkCount, unsigned int chunk,
+                 unsigned int& begin, unsigned int& end) noexcept
+{
+    unsigned int base = count / chunkCount;
+    unsigned int extra = count % chunkCount;
+
+    begin = chunk * base + (chunk < extra ? chunk : extra);
+    end = begin + base + (chunk < extra ? 1 : 0);
+}
+
+
+std::vector<std::string> readWordsParallel(const std::string& path, unsigned int threadCount)
+{
+    std::ifstream file{path, std::ios::binary};
+    if(!file) {
+        return {};
+    }
+
+    std::string contents{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+
+    if(threadCount == 0) {
+        threadCount = 1;
+    }
+
+    // each range starts just after a newline (or at the beginning of the
+    // file) and ends just after one (or at the end of the file)
+    std::vector<std::string::size_type> starts(threadCount + 1, contents.size());
+    starts[0] = 0;
+
+    for(unsigned int t = 1; t < threadCount; t++) {
+        std::string::size_type guess = contents.size() / threadCount * t;
+        std::string::size_type newline = contents.find('\n', guess < starts[t - 1] ? starts[t - 1] : guess);
+        starts[t] = newline == std::string::npos ? contents.size() : newline + 1;
+    }
+
+    std::vector<std::vector<std::string>> parts(threadCount);
+
+    parallelFor(threadCount, [&](unsigned int t) {
+        std::string::size_type position = starts[t];
+        std::string::size_type end = starts[t + 1];
+
+        while(position < end) {
+            std::string::size_type newline = contents.find('\n', position);
+            if(newline == std::string::npos || newline > end) {
+                newline = end;
+            }
+
+            std::string::size_type wordEnd = newline;
+            if(wordEnd > position && contents[wordEnd - 1] == '\r') {
+                wordEnd--;
+            }
+
+            if(wordEnd > position) {
+                parts[t].emplace_back(contents, position, wordEnd - position);
+            }
+
+            position = newline + 1;
+        }
+    });
+
+    std::vector<std::string> words;
+    std::vector<std::string>::size_type total = 0;
+    for(const std::vector<std::string>& part : parts) {
+        total += part.size();
+    }
+    words.reserve(total);
+
+    for(std::vector<std::string>& part : parts) {
+        std::move(part.begin(), part.end(), std::back_inserter(words));
+    }
+
+    return words;
+}
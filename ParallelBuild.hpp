@@ -0,0 +1,106 @@
+// ParallelBuild.hpp
+//
+// ICS 46 Spring 2018
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// Utilities for building dictionaries using multiple threads: running a
+// task on several threads at once, dividing work into even chunks, sorting
+// in parallel, and reading a word list with the parsing spread across
+// threads.  The bulk addAll() functions of the sets are built on these.
+//
+// You are permitted to use the C++ Standard Library in these utilities.
+
+#ifndef PARALLELBUILD_HPP
+#define PARALLELBUILD_HPP
+
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+
+// defaultThreadCount() returns the number of threads the hardware can run
+// at once, or 1 if that can't be determined.
+unsigned int defaultThreadCount() noexcept;
+
+
+// chunkBounds() divides "count" items into "chunkCount" chunks whose sizes
+// differ by at most one, and sets "begin" and "end" to the bounds of the
+// given chunk.
+void chunkBounds(unsigned int count, unsigned int chunkCount, unsigned int chunk,
+                 unsigned int& begin, unsigned int& end) noexcept;
+
+
+// parallelFor() calls task(0) through task(taskCount - 1), each on its own
+// thread (task(0) runs on the calling thread), and returns once all of
+// them have finished.
+template <typename Task>
+void parallelFor(unsigned int taskCount, Task task)
+{
+    std::vector<std::thread> threads;
+
+    for(unsigned int t = 1; t < taskCount; t++) {
+        threads.emplace_back(task, t);
+    }
+
+    if(taskCount > 0) {
+        task(0);
+    }
+
+    for(std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+
+// parallelSort() sorts an array into ascending order using the given number
+// of threads: each thread sorts one chunk, and then neighboring chunks are
+// merged pairwise, with the merges at each round also running in parallel.
+template <typename ElementType, typename Compare = std::less<ElementType>>
+void parallelSort(ElementType* elements, unsigned int count, unsigned int threadCount, Compare compare = Compare{})
+{
+    if(threadCount == 0) {
+        threadCount = 1;
+    }
+    if(threadCount > count) {
+        threadCount = count == 0 ? 1 : count;
+    }
+
+    std::vector<unsigned int> bounds(threadCount + 1);
+    for(unsigned int t = 0; t < threadCount; t++) {
+        chunkBounds(count, threadCount, t, bounds[t], bounds[t + 1]);
+    }
+
+    parallelFor(threadCount, [&](unsigned int t) {
+        std::sort(elements + bounds[t], elements + bounds[t + 1], compare);
+    });
+
+    for(unsigned int width = 1; width < threadCount; width *= 2) {
+        unsigned int merges = (threadCount + 2 * width - 1) / (2 * width);
+
+        parallelFor(merges, [&](unsigned int m) {
+            unsigned int first = 2 * width * m;
+            unsigned int middle = std::min(first + width, threadCount);
+            unsigned int last = std::min(first + 2 * width, threadCount);
+
+            std::inplace_merge(
+                elements + bounds[first], elements + bounds[middle], elements + bounds[last], compare);
+        });
+    }
+}
+
+
+// readWordsParallel() reads a word list with one word per line from the
+// file at the given path.  The file is read into memory in one piece and
+// then split into one range per thread, each adjusted to start and end on
+// a line boundary, and each thread parses its own range.  Trailing
+// carriage returns are dropped, as are empty lines.  The words are
+// returned in the order they appear in the file; if the file can't be
+// read, an empty vector is returned.
+std::vector<std::string> readWordsParallel(const std::string& path, unsigned int threadCount);
+
+
+
+#endif // PARALLELBUILD_HPP
@@ -0,0 +1,476 @@
+// PersistentAVLSet.hpp
+//
+// ICS 46 Spring 2018
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// A PersistentAVLSet is an AVL tree whose nodes are never changed once
+// they're built, so any number of versions of the set can share them.
+// Adding an element copies only the nodes on the path from the root down
+// to where the element goes (and the few that a rotation on that path
+// touches) -- O(log n) of them -- and the new version's tree points to the
+// old one's nodes everywhere else.  The version it was added to is left
+// just as it was.
+//
+// That makes a snapshot cheap: snapshot() (or the copy constructor) takes
+// O(1) time, rather than the O(n log n) that copying an AVLSet takes, and
+// many versions can be kept at once for the cost of the nodes in which
+// they differ.  A reader can be handed a snapshot and keep using it, as a
+// stable view, while the writer goes on adding to its own version.
+//
+// Each node counts the versions and parent nodes that refer to it, and it
+// is destroyed when the last of them lets go.  The counts are atomic, so
+// versions that share nodes can be used, copied and destroyed on different
+// threads at once.  A single PersistentAVLSet object, though, is like any
+// other Set: it mustn't be changed by one thread while another uses it,
+// which is what snapshots are for.
+
+#ifndef PERSISTENTAVLSET_HPP
+#define PERSISTENTAVLSET_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include "Set.hpp"
+
+
+
+template <typename ElementType>
+class PersistentAVLSet : public Set<ElementType>
+{
+public:
+    // A VisitFunction is a function that takes a reference to a const
+    // ElementType and returns no value.
+    using VisitFunction = std::function<void(const ElementType&)>;
+
+public:
+    // Initializes a PersistentAVLSet to be empty.
+    PersistentAVLSet() noexcept;
+
+    // Cleans up the PersistentAVLSet, destroying the nodes that no other
+    // version shares.
+    virtual ~PersistentAVLSet() noexcept;
+
+    // Initializes a new PersistentAVLSet to be a snapshot of an existing
+    // one, sharing all of its nodes, in O(1) time.
+    PersistentAVLSet(const PersistentAVLSet& s) noexcept;
+
+    // Initializes a new PersistentAVLSet whose version is taken from an
+    // expiring one.
+    PersistentAVLSet(PersistentAVLSet&& s) noexcept;
+
+    // Makes this PersistentAVLSet a snapshot of an existing one, in O(1)
+    // time (plus the time to destroy the nodes of its old version that no
+    // other version shares).
+    PersistentAVLSet& operator=(const PersistentAVLSet& s) noexcept;
+
+    PersistentAVLSet& operator=(PersistentAVLSet&& s) noexcept;
+
+
+    // isImplemented() returns true, since a PersistentAVLSet is
+    // implemented.
+    virtual bool isImplemented() const noexcept override;
+
+
+    // add() makes this set's version one that also contains the given
+    // element, copying O(log n) nodes; snapshots taken earlier don't
+    // change.  If the element is already in the set, this function has no
+    // effect.
+    virtual void add(const ElementType& element) override;
+
+
+    // with() returns a new version that also contains the given element,
+    // leaving this one unchanged.
+    PersistentAVLSet with(const ElementType& element) const;
+
+
+    // snapshot() returns a version equal to this one, sharing all of its
+    // nodes, in O(1) time.
+    PersistentAVLSet snapshot() const noexcept;
+
+
+    // contains() returns true if the given element is in the set, false
+    // otherwise.  This function always runs in O(log n) time.
+    virtual bool contains(const ElementType& element) const override;
+
+
+    // size() returns the number of elements in the set.
+    virtual unsigned int size() const noexcept override;
+
+
+    // height() returns the height of the AVL tree.  Note that, by
+    // definition, the height of an empty tree is -1.
+    int height() const noexcept;
+
+
+    // inorder() calls the given "visit" function for each of the elements
+    // in the set, in ascending order.
+    void inorder(VisitFunction visit) const;
+
+
+private:
+    struct Node
+    {
+        ElementType element;
+        const Node* left;
+        const Node* right;
+        int height;
+
+        // the number of versions and nodes that refer to this node
+        mutable std::atomic<unsigned int> references;
+
+        Node(const ElementType& element, const Node* left, const Node* right);
+    };
+
+    // A Reference holds one reference to a node and releases it when it's
+    // destroyed, unless take() has handed it over first, so that a node
+    // isn't leaked when building another one throws.
+    class Reference
+    {
+    public:
+        explicit Reference(const Node* node) noexcept;
+        ~Reference() noexcept;
+
+        Reference(const Reference& r) = delete;
+        Reference& operator=(const Reference& r) = delete;
+
+        const Node* take() noexcept;
+
+    private:
+        const Node* node;
+    };
+
+    const Node* root;
+    unsigned int _size;
+
+    // acquire() adds a reference to a node (if it isn't NULL) and returns
+    // it.  release() removes one, destroying the node (and releasing its
+    // children) if it was the last.
+    static const Node* acquire(const Node* node) noexcept;
+    static void release(const Node* node) noexcept;
+
+    static int heightOf(const Node* node) noexcept;
+
+    // makeNode() builds a node whose children are "left" and "right", taking
+    // over the references to them that the caller holds.
+    static const Node* makeNode(const ElementType& element, const Node* left, const Node* right);
+
+    // balance() is makeNode() for a node whose subtrees' heights may differ
+    // by two; it builds the node rotated back into balance.
+    static const Node* balance(const ElementType& element, const Node* left, const Node* right);
+
+    // insert() returns a new version of the subtree rooted at "node" with
+    // the element added, holding one reference to it, or NULL if the
+    // element was already there.
+    static const Node* insert(const Node* node, const ElementType& element);
+
+    static void recursiveInorder(const VisitFunction& visit, const Node* node);
+};
+
+
+
+template <typename ElementType>
+PersistentAVLSet<ElementType>::Node::Node(const ElementType& element, const Node* left, const Node* right)
+    : element{element}, left{left}, right{right},
+      height{1 + (heightOf(left) > heightOf(right) ? heightOf(left) : heightOf(right))},
+      references{1}
+{
+}
+
+
+template <typename ElementType>
+PersistentAVLSet<ElementType>::Reference::Reference(const Node* node) noexcept
+    : node{node}
+{
+}
+
+
+template <typename ElementType>
+PersistentAVLSet<ElementType>::Reference::~Reference() noexcept
+{
+    release(node);
+}
+
+
+template <typename ElementType>
+const typename PersistentAVLSet<ElementType>::Node* PersistentAVLSet<ElementType>::Reference::take() noexcept
+{
+    const Node* taken = node;
+    node = NULL;
+    return taken;
+}
+
+
+template <typename ElementType>
+PersistentAVLSet<ElementType>::PersistentAVLSet() noexcept
+    : root{NULL}, _size{0}
+{
+}
+
+
+template <typename ElementType>
+PersistentAVLSet<ElementType>::~PersistentAVLSet() noexcept
+{
+    release(root);
+}
+
+
+template <typename ElementType>
+PersistentAVLSet<ElementType>::PersistentAVLSet(const PersistentAVLSet& s) noexcept
+    : root{acquire(s.root)}, _size{s._size}
+{
+}
+
+
+template <typename ElementType>
+PersistentAVLSet<ElementType>::PersistentAVLSet(PersistentAVLSet&& s) noexcept
+    : root{s.root}, _size{s._size}
+{
+    s.root = NULL;
+    s._size = 0;
+}
+
+
+template <typename ElementType>
+PersistentAVLSet<ElementType>& PersistentAVLSet<ElementType>::operator=(const PersistentAVLSet& s) noexcept
+{
+    // acquiring first makes assigning a set to itself harmless
+    const Node* previous = root;
+    root = acquire(s.root);
+    _size = s._size;
+    release(previous);
+
+    return *this;
+}
+
+
+template <typename ElementType>
+PersistentAVLSet<ElementType>& PersistentAVLSet<ElementType>::operator=(PersistentAVLSet&& s) noexcept
+{
+    if(this != &s) {
+        release(root);
+        root = s.root;
+        _size = s._size;
+        s.root = NULL;
+        s._size = 0;
+    }
+
+    return *this;
+}
+
+
+template <typename ElementType>
+bool PersistentAVLSet<ElementType>::isImplemented() const noexcept
+{
+    return true;
+}
+
+
+template <typename ElementType>
+void PersistentAVLSet<ElementType>::add(const ElementType& element)
+{
+    const Node* added = insert(root, element);
+    if(added == NULL) {
+        return;
+    }
+
+    release(root);
+    root = added;
+    _size++;
+}
+
+
+template <typename ElementType>
+PersistentAVLSet<ElementType> PersistentAVLSet<ElementType>::with(const ElementType& element) const
+{
+    PersistentAVLSet version{*this};
+    version.add(element);
+    return version;
+}
+
+
+template <typename ElementType>
+PersistentAVLSet<ElementType> PersistentAVLSet<ElementType>::snapshot() const noexcept
+{
+    return PersistentAVLSet{*this};
+}
+
+
+template <typename ElementType>
+bool PersistentAVLSet<ElementType>::contains(const ElementType& element) const
+{
+    const Node* node = root;
+
+    while(node != NULL) {
+        if(element == node->element) {
+            return true;
+        }
+        node = element < node->element ? node->left : node->right;
+    }
+
+    return false;
+}
+
+
+template <typename ElementType>
+unsigned int PersistentAVLSet<ElementType>::size() const noexcept
+{
+    return _size;
+}
+
+
+template <typename ElementType>
+int PersistentAVLSet<ElementType>::height() const noexcept
+{
+    return heightOf(root);
+}
+
+
+template <typename ElementType>
+void PersistentAVLSet<ElementType>::inorder(VisitFunction visit) const
+{
+    recursiveInorder(visit, root);
+}
+
+
+template <typename ElementType>
+const typename PersistentAVLSet<ElementType>::Node* PersistentAVLSet<ElementType>::acquire(const Node* node) noexcept
+{
+    if(node != NULL) {
+        node->references.fetch_add(1, std::memory_order_relaxed);
+    }
+    return node;
+}
+
+
+template <typename ElementType>
+void PersistentAVLSet<ElementType>::release(const Node* node) noexcept
+{
+    // the last reference's release has to see every change made through
+    // the others before the node is destroyed
+    while(node != NULL && node->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        const Node* left = node->left;
+        const Node* right = node->right;
+        delete node;
+
+        // one child is released recursively and the other in this loop, so
+        // the recursion is no deeper than the tree
+        release(left);
+        node = right;
+    }
+}
+
+
+template <typename ElementType>
+int PersistentAVLSet<ElementType>::heightOf(const Node* node) noexcept
+{
+    return node == NULL ? -1 : node->height;
+}
+
+
+template <typename ElementType>
+const typename PersistentAVLSet<ElementType>::Node* PersistentAVLSet<ElementType>::makeNode(
+    const ElementType& element, const Node* left, const Node* right)
+{
+    try {
+        return new Node(element, left, right);
+    }
+    catch(...) {
+        release(left);
+        release(right);
+        throw;
+    }
+}
+
+
+template <typename ElementType>
+const typename PersistentAVLSet<ElementType>::Node* PersistentAVLSet<ElementType>::balance(
+    const ElementType& element, const Node* left, const Node* right)
+{
+    // A rotation builds new nodes out of the parts of the taller child; the
+    // parts it keeps are acquired for the new nodes, and then the child
+    // itself is released (which destroys it only if it was new, too).  The
+    // taller child, and any node built but not yet handed to another, are
+    // held by References, so they're released even if makeNode() throws;
+    // makeNode() releases the nodes it was handed itself.
+    if(heightOf(left) > heightOf(right) + 1) {
+        Reference taller{left};
+
+        if(heightOf(left->left) >= heightOf(left->right)) {
+            // single rotation to the right
+            const Node* newRight = makeNode(element, acquire(left->right), right);
+            return makeNode(left->element, acquire(left->left), newRight);
+        }
+        else {
+            // double rotation: left, then right
+            Reference shorter{right};
+            const Node* middle = left->right;
+            Reference newLeft{makeNode(left->element, acquire(left->left), acquire(middle->left))};
+            const Node* newRight = makeNode(element, acquire(middle->right), shorter.take());
+            return makeNode(middle->element, newLeft.take(), newRight);
+        }
+    }
+    else if(heightOf(right) > heightOf(left) + 1) {
+        Reference taller{right};
+
+        if(heightOf(right->right) >= heightOf(right->left)) {
+            // single rotation to the left
+            const Node* newLeft = makeNode(element, left, acquire(right->left));
+            return makeNode(right->element, newLeft, acquire(right->right));
+        }
+        else {
+            // double rotation: right, then left
+            const Node* middle = right->left;
+            Reference newLeft{makeNode(element, left, acquire(middle->left))};
+            const Node* newRight = makeNode(right->element, acquire(middle->right), acquire(right->right));
+            return makeNode(middle->element, newLeft.take(), newRight);
+        }
+    }
+
+    return makeNode(element, left, right);
+}
+
+
+template <typename ElementType>
+const typename PersistentAVLSet<ElementType>::Node* PersistentAVLSet<ElementType>::insert(
+    const Node* node, const ElementType& element)
+{
+    if(node == NULL) {
+        return makeNode(element, NULL, NULL);
+    }
+
+    if(element == node->element) {
+        return NULL;
+    }
+
+    if(element < node->element) {
+        const Node* newLeft = insert(node->left, element);
+        if(newLeft == NULL) {
+            return NULL;
+        }
+        return balance(node->element, newLeft, acquire(node->right));
+    }
+    else {
+        const Node* newRight = insert(node->right, element);
+        if(newRight == NULL) {
+            return NULL;
+        }
+        return balance(node->element, acquire(node->left), newRight);
+    }
+}
+
+
+template <typename ElementType>
+void PersistentAVLSet<ElementType>::recursiveInorder(const VisitFunction& visit, const Node* node)
+{
+    if(node == NULL) {
+        return;
+    }
+
+    recursiveInorder(visit, node->left);
+    visit(node->element);
+    recursiveInorder(visit, node->right);
+}
+
+
+
+#endif // PERSISTENTAVLSET_HPP
@@ -0,0 +1,344 @@
+// PhoneticIndex.cpp
+//
+// ICS 46 Spring 2018
+// Project #4: Set the Controls for the Heart of the Sun
+
+#include "PhoneticIndex.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+
+
+namespace
+{
+    bool isVowel(char c)
+    {
+        return c == 'A' || c == 'E' || c == 'I' || c == 'O' || c == 'U';
+    }
+
+    bool isFrontVowel(char c)
+    {
+        return c == 'E' || c == 'I' || c == 'Y';
+    }
+
+    bool startsWith(const std::string& s, const char* prefix)
+    {
+        return s.compare(0, 2, prefix) == 0;
+    }
+}
+
+
+
+PhoneticIndex::PhoneticIndex()
+    : wordStarts(1, 0), postingStarts(1, 0)
+{
+}
+
+
+void PhoneticIndex::add(const std::string& word)
+{
+    std::string code = encode(word);
+    if(code.empty()) {
+        return;
+    }
+
+    pending.emplace_back(pack(code), static_cast<std::uint32_t>(wordStarts.size() - 1));
+
+    text.insert(text.end(), word.begin(), word.end());
+    wordStarts.push_back(static_cast<std::uint32_t>(text.size()));
+}
+
+
+void PhoneticIndex::build()
+{
+    // words from an earlier build() go back in with the new ones
+    for(std::size_t k = 0; k < codes.size(); k++) {
+        for(std::uint32_t p = postingStarts[k]; p < postingStarts[k + 1]; p++) {
+            pending.emplace_back(codes[k], postings[p]);
+        }
+    }
+
+    std::sort(pending.begin(), pending.end());
+
+    codes.clear();
+    postingStarts.assign(1, 0);
+    postings.clear();
+    postings.reserve(pending.size());
+
+    for(std::size_t i = 0; i < pending.size(); i++) {
+        if(i == 0 || pending[i].first != pending[i - 1].first) {
+            if(i != 0) {
+                postingStarts.push_back(static_cast<std::uint32_t>(postings.size()));
+            }
+            codes.push_back(pending[i].first);
+        }
+        postings.push_back(pending[i].second);
+    }
+    if(!pending.empty()) {
+        postingStarts.push_back(static_cast<std::uint32_t>(postings.size()));
+    }
+
+    codes.shrink_to_fit();
+    postingStarts.shrink_to_fit();
+    text.shrink_to_fit();
+    wordStarts.shrink_to_fit();
+
+    pending.clear();
+    pending.shrink_to_fit();
+}
+
+
+std::vector<std::string> PhoneticIndex::soundAlikes(const std::string& word, unsigned int limit) const
+{
+    std::vector<std::string> result;
+
+    std::uint64_t code = pack(encode(word));
+    auto found = std::lower_bound(codes.begin(), codes.end(), code);
+    if(found == codes.end() || *found != code) {
+        return result;
+    }
+
+    std::size_t k = found - codes.begin();
+    for(std::uint32_t p = postingStarts[k]; p < postingStarts[k + 1]; p++) {
+        std::string alike = wordAt(postings[p]);
+        if(alike != word) {
+            result.push_back(std::move(alike));
+        }
+    }
+
+    auto distance = [&](const std::string& s) {
+        return std::labs(static_cast<long>(s.size()) - static_cast<long>(word.size()));
+    };
+
+    std::sort(result.begin(), result.end(),
+        [&](const std::string& a, const std::string& b) {
+            long da = distance(a), db = distance(b);
+            return da != db ? da < db : a < b;
+        });
+
+    if(result.size() > limit) {
+        result.resize(limit);
+    }
+    return result;
+}
+
+
+std::string PhoneticIndex::encode(const std::string& word)
+{
+    std::string w;
+    for(char c : word) {
+        if(std::isalpha(static_cast<unsigned char>(c))) {
+            w += static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        }
+    }
+
+    std::string::size_type n = w.size();
+    auto at = [&](std::string::size_type k) { return k < n ? w[k] : '\0'; };
+
+    std::string code;
+    std::string::size_type i = 0;
+
+    // some beginnings have a silent first letter or an unusual sound
+    if(startsWith(w, "KN") || startsWith(w, "GN") || startsWith(w, "PN")
+        || startsWith(w, "AE") || startsWith(w, "WR")) {
+        i = 1;
+    }
+    else if(at(0) == 'X') {
+        code += 'S';
+        i = 1;
+    }
+    else if(startsWith(w, "WH")) {
+        code += 'W';
+        i = 2;
+    }
+
+    for(; i < n && code.size() < MAX_CODE_LENGTH; i++) {
+        char c = w[i];
+        char previous = i > 0 ? w[i - 1] : '\0';
+
+        // a doubled letter sounds once (but "CC" can sound like "KS")
+        if(c == previous && c != 'C') {
+            continue;
+        }
+
+        switch(c) {
+        case 'A': case 'E': case 'I': case 'O': case 'U':
+            if(i == 0) {
+                code += 'A';
+            }
+            break;
+
+        case 'B':
+            // silent in a final "MB"
+            if(!(i + 1 == n && previous == 'M')) {
+                code += 'B';
+            }
+            break;
+
+        case 'C':
+            if(previous == 'S' && at(i + 1) == 'H') {
+                code += 'K';
+                i++;
+            }
+            else if(at(i + 1) == 'H' || (at(i + 1) == 'I' && at(i + 2) == 'A')) {
+                code += 'X';
+                if(at(i + 1) == 'H') {
+                    i++;
+                }
+            }
+            else if(isFrontVowel(at(i + 1))) {
+                if(previous != 'S') {
+                    code += 'S';
+                }
+            }
+            else {
+                code += 'K';
+            }
+            break;
+
+        case 'D':
+            if(at(i + 1) == 'G' && isFrontVowel(at(i + 2))) {
+                code += 'J';
+                i++;
+            }
+            else {
+                code += 'T';
+            }
+            break;
+
+        case 'G':
+            if(at(i + 1) == 'H' && !isVowel(at(i + 2))) {
+                // silent, as in "NIGHT" and "HIGH"
+                i++;
+            }
+            else if(at(i + 1) == 'N' && (i + 2 == n || (at(i + 2) == 'E' && at(i + 3) == 'D' && i + 4 == n))) {
+                // silent, as in "SIGN" and "SIGNED"
+            }
+            else if(isFrontVowel(at(i + 1))) {
+                code += 'J';
+            }
+            else {
+                code += 'K';
+            }
+            break;
+
+        case 'H':
+            if(isVowel(at(i + 1)) && previous != 'C' && previous != 'G' && previous != 'P'
+                && previous != 'S' && previous != 'T') {
+                code += 'H';
+            }
+            break;
+
+        case 'K':
+            if(previous != 'C') {
+                code += 'K';
+            }
+            break;
+
+        case 'P':
+            if(at(i + 1) == 'H') {
+                code += 'F';
+                i++;
+            }
+            else {
+                code += 'P';
+            }
+            break;
+
+        case 'Q':
+            code += 'K';
+            break;
+
+        case 'S':
+            if(at(i + 1) == 'H') {
+                code += 'X';
+                i++;
+            }
+            else if(at(i + 1) == 'I' && (at(i + 2) == 'O' || at(i + 2) == 'A')) {
+                code += 'X';
+            }
+            else {
+                code += 'S';
+            }
+            break;
+
+        case 'T':
+            if(at(i + 1) == 'I' && (at(i + 2) == 'O' || at(i + 2) == 'A')) {
+                code += 'X';
+            }
+            else if(at(i + 1) == 'H') {
+                // "TH" is written as a zero, for the theta
+                code += '0';
+                i++;
+            }
+            else if(!(at(i + 1) == 'C' && at(i + 2) == 'H')) {
+                code += 'T';
+            }
+            break;
+
+        case 'V':
+            code += 'F';
+            break;
+
+        case 'W': case 'Y':
+            if(isVowel(at(i + 1))) {
+                code += c;
+            }
+            break;
+
+        case 'X':
+            code += "KS";
+            break;
+
+        case 'Z':
+            code += 'S';
+            break;
+
+        default:
+            // F, J, L, M, N, and R sound as they're written
+            code += c;
+            break;
+        }
+    }
+
+    if(code.size() > MAX_CODE_LENGTH) {
+        code.resize(MAX_CODE_LENGTH);
+    }
+    return code;
+}
+
+
+unsigned int PhoneticIndex::size() const noexcept
+{
+    return static_cast<unsigned int>(wordStarts.size() - 1);
+}
+
+
+std::size_t PhoneticIndex::memoryUsage() const noexcept
+{
+    return text.capacity() * sizeof(char)
+        + wordStarts.capacity() * sizeof(std::uint32_t)
+        + codes.capacity() * sizeof(std::uint64_t)
+        + postingStarts.capacity() * sizeof(std::uint32_t)
+        + postings.capacity() * sizeof(std::uint32_t)
+        + pending.capacity() * sizeof(std::pair<std::uint64_t, std::uint32_t>);
+}
+
+
+std::uint64_t PhoneticIndex::pack(const std::string& code) noexcept
+{
+    std::uint64_t packed = 0;
+    for(unsigned int i = 0; i < MAX_CODE_LENGTH; i++) {
+        unsigned char c = i < code.size() ? static_cast<unsigned char>(code[i]) : 0;
+        packed = (packed << 8) | c;
+    }
+    return packed;
+}
+
+
+std::string PhoneticIndex::wordAt(std::uint32_t index) const
+{
+    return std::string(text.data() + wordStarts[index], text.data() + wordStarts[index + 1]);
+}
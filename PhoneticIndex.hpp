@@ -0,0 +1,119 @@
+// PhoneticIndex.hpp
+//
+// ICS 46 Spring 2018
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// A PhoneticIndex finds the words that sound like a given word, even when
+// they're spelled very differently ("FOTOGRAF" and "PHOTOGRAPH").  None of
+// the WordChecker's five techniques can find those, since they're many
+// edits apart.
+//
+// Each word is reduced to a phonetic code by a simplified form of the
+// Metaphone algorithm: letters that sound alike map to the same code letter
+// ("PH" and "F" both become F, a "C" before "E", "I" or "Y" becomes S),
+// silent letters and vowels after the first letter are dropped, and doubled
+// letters count once.  Words with the same code are taken to sound alike.
+//
+// The index is built once, after the words are added.  It stores the words'
+// text in one pool of characters, the distinct codes in a sorted array, and
+// for each code a posting list of the words with that code, with all the
+// posting lists in one more pool.  Looking up a word encodes it and finds
+// its code with one binary search.
+//
+// You are permitted to use the C++ Standard Library in this class.
+
+#ifndef PHONETICINDEX_HPP
+#define PHONETICINDEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+
+class PhoneticIndex
+{
+public:
+    // Codes are cut off after this many letters.
+    static constexpr unsigned int MAX_CODE_LENGTH = 8;
+
+    // The most sound-alikes that soundAlikes() returns unless told otherwise.
+    static constexpr unsigned int DEFAULT_LIMIT = 10;
+
+public:
+    // Initializes a PhoneticIndex with no words in it.
+    PhoneticIndex();
+
+
+    // add() adds a word to the index.  Each word should be added only once.
+    // The index isn't updated until build() is called.
+    void add(const std::string& word);
+
+
+    // addAll() adds every element of an ordered set (such as an AVLSet).
+    template <typename OrderedSet>
+    void addAll(const OrderedSet& words);
+
+
+    // build() sorts the words added so far by their codes and lays out the
+    // posting lists.  It runs in O(n log n) time for n words, and must be
+    // called after adding words and before calling soundAlikes().
+    void build();
+
+
+    // soundAlikes() returns up to "limit" words that have the same code as
+    // the given word, other than the word itself.  Those closest to the
+    // word's length come first, and words of equal closeness are in
+    // ascending order.
+    std::vector<std::string> soundAlikes(const std::string& word, unsigned int limit = DEFAULT_LIMIT) const;
+
+
+    // encode() returns the phonetic code of a word.  Case is ignored, as
+    // is anything other than a letter.
+    static std::string encode(const std::string& word);
+
+
+    // size() returns the number of words that have been added.
+    unsigned int size() const noexcept;
+
+
+    // memoryUsage() returns the number of bytes that the index occupies,
+    // not counting the PhoneticIndex object itself.
+    std::size_t memoryUsage() const noexcept;
+
+
+private:
+    // the characters of word i are text[wordStarts[i]] up to
+    // text[wordStarts[i + 1]]
+    std::vector<char> text;
+    std::vector<std::uint32_t> wordStarts;
+
+    // codes are packed into integers, one letter per byte with the first
+    // letter highest, so that they compare as the strings would; the words
+    // with codes[k] are postings[postingStarts[k]] up to
+    // postings[postingStarts[k + 1]]
+    std::vector<std::uint64_t> codes;
+    std::vector<std::uint32_t> postingStarts;
+    std::vector<std::uint32_t> postings;
+
+    // the code of each word added since the last build()
+    std::vector<std::pair<std::uint64_t, std::uint32_t>> pending;
+
+    static std::uint64_t pack(const std::string& code) noexcept;
+
+    std::string wordAt(std::uint32_t index) const;
+};
+
+
+
+template <typename OrderedSet>
+void PhoneticIndex::addAll(const OrderedSet& words)
+{
+    words.inorder([&](const std::string& word) { add(word); });
+}
+
+
+
+#endif // PHONETICINDEX_HPP
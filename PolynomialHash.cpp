@@ -0,0 +1,130 @@
+// PolynomialHash.cpp
+//
+// ICS 46 Spring 2018
+// Project #4: Set the Controls for the Heart of the Sun
+
+#include "PolynomialHash.hpp"
+
+
+
+unsigned int PolynomialHash::hash(const std::string& s)
+{
+    return finish(raw(s));
+}
+
+
+std::uint64_t PolynomialHash::raw(const std::string& s) noexcept
+{
+    std::uint64_t h = 0;
+    for(char c : s) {
+        h = add(multiply(h, BASE), character(c));
+    }
+    return h;
+}
+
+
+unsigned int PolynomialHash::finish(std::uint64_t raw) noexcept
+{
+    // the finalizer from MurmurHash3's 64-bit hash
+    raw ^= raw >> 33;
+    raw *= 0xFF51AFD7ED558CCDULL;
+    raw ^= raw >> 33;
+    raw *= 0xC4CEB9FE1A85EC53ULL;
+    raw ^= raw >> 33;
+    return static_cast<unsigned int>(raw);
+}
+
+
+PolynomialHash::Word::Word(const std::string& word)
+    : word{word}, prefixes(word.size() + 1), powers(word.size() + 2)
+{
+    prefixes[0] = 0;
+    powers[0] = 1;
+
+    for(std::string::size_type i = 0; i < word.size(); i++) {
+        prefixes[i + 1] = add(multiply(prefixes[i], BASE), character(word[i]));
+        powers[i + 1] = multiply(powers[i], BASE);
+    }
+    powers[word.size() + 1] = multiply(powers[word.size()], BASE);
+}
+
+
+const std::string& PolynomialHash::Word::text() const noexcept
+{
+    return word;
+}
+
+
+std::uint64_t PolynomialHash::Word::piece(std::string::size_type begin, std::string::size_type end) const noexcept
+{
+    return subtract(prefixes[end], multiply(prefixes[begin], powers[end - begin]));
+}
+
+
+std::uint64_t PolynomialHash::Word::swapped(std::string::size_type i) const noexcept
+{
+    // the two characters trade places, so each one's coefficient changes
+    // from B^k to B^(k +/- 1)
+    std::string::size_type n = word.size();
+    std::uint64_t a = character(word[i]);
+    std::uint64_t b = character(word[i + 1]);
+
+    std::uint64_t h = prefixes[n];
+    h = add(h, multiply(subtract(b, a), powers[n - 1 - i]));
+    h = add(h, multiply(subtract(a, b), powers[n - 2 - i]));
+    return h;
+}
+
+
+std::uint64_t PolynomialHash::Word::inserted(std::string::size_type i, char c) const noexcept
+{
+    std::string::size_type n = word.size();
+    std::uint64_t front = add(multiply(prefixes[i], BASE), character(c));
+    return add(multiply(front, powers[n - i]), piece(i, n));
+}
+
+
+std::uint64_t PolynomialHash::Word::deleted(std::string::size_type i) const noexcept
+{
+    std::string::size_type n = word.size();
+    return add(multiply(prefixes[i], powers[n - 1 - i]), piece(i + 1, n));
+}
+
+
+std::uint64_t PolynomialHash::Word::replaced(std::string::size_type i, char c) const noexcept
+{
+    std::string::size_type n = word.size();
+    std::uint64_t difference = subtract(character(c), character(word[i]));
+    return add(prefixes[n], multiply(difference, powers[n - 1 - i]));
+}
+
+
+std::uint64_t PolynomialHash::add(std::uint64_t a, std::uint64_t b) noexcept
+{
+    std::uint64_t sum = a + b;
+    return sum >= MODULUS ? sum - MODULUS : sum;
+}
+
+
+std::uint64_t PolynomialHash::subtract(std::uint64_t a, std::uint64_t b) noexcept
+{
+    return a >= b ? a - b : a + MODULUS - b;
+}
+
+
+std::uint64_t PolynomialHash::multiply(std::uint64_t a, std::uint64_t b) noexcept
+{
+    // since the modulus is 2^61 - 1, the high bits of the product can be
+    // folded back onto the low bits instead of dividing
+    unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+    std::uint64_t folded = (static_cast<std::uint64_t>(product) & MODULUS) + static_cast<std::uint64_t>(product >> 61);
+    folded = (folded & MODULUS) + (folded >> 61);
+    return folded >= MODULUS ? folded - MODULUS : folded;
+}
+
+
+std::uint64_t PolynomialHash::character(char c) noexcept
+{
+    // 1 through 256, so that no character counts as nothing
+    return static_cast<std::uint64_t>(static_cast<unsigned char>(c)) + 1;
+}
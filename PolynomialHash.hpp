@@ -0,0 +1,102 @@
+// PolynomialHash.hpp
+//
+// ICS 46 Spring 2018
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// PolynomialHash is a hash function for strings that can be used by a
+// HashSet, and whose value for a string that differs from a known word by
+// one edit can be worked out in constant time, without building the string.
+//
+// A string s of n characters is first reduced to the polynomial
+//
+//     s[0] * B^(n-1) + s[1] * B^(n-2) + ... + s[n-1]     (mod 2^61 - 1)
+//
+// for a fixed base B; this is its "raw" hash.  Raw hashes compose: the raw
+// hash of a concatenation xy is raw(x) * B^|y| + raw(y).  So once the raw
+// hashes of every prefix of a word are known, the raw hash of any piece of
+// it, and of the word with a letter inserted, deleted, replaced, or two
+// letters swapped, takes a few multiplications.  hash() mixes the raw hash
+// down to an unsigned int, spreading its bits so that the remainders a
+// HashSet takes of it are evenly distributed.
+//
+// A PolynomialHash::Word holds those prefix hashes for one word.
+//
+// You are permitted to use the C++ Standard Library in this class.
+
+#ifndef POLYNOMIALHASH_HPP
+#define POLYNOMIALHASH_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+
+class PolynomialHash
+{
+public:
+    // hash() returns the hash of a string, suitable for a HashSet.
+    static unsigned int hash(const std::string& s);
+
+    // raw() returns the raw (unmixed) hash of a string.
+    static std::uint64_t raw(const std::string& s) noexcept;
+
+    // finish() mixes a raw hash into the value that hash() would return
+    // for the same string.
+    static unsigned int finish(std::uint64_t raw) noexcept;
+
+
+    // A Word holds the raw hashes of every prefix of a word, along with
+    // the powers of the base up to its length, and computes the raw hashes
+    // of the candidates that WordChecker generates from it.  Each of those
+    // takes constant time.  The word itself must outlive the Word.
+    class Word
+    {
+    public:
+        explicit Word(const std::string& word);
+
+        const std::string& text() const noexcept;
+
+        // piece() returns the raw hash of the characters from "begin" up to
+        // (but not including) "end".
+        std::uint64_t piece(std::string::size_type begin, std::string::size_type end) const noexcept;
+
+        // swapped() returns the raw hash of the word with the characters at
+        // i and i + 1 swapped.
+        std::uint64_t swapped(std::string::size_type i) const noexcept;
+
+        // inserted() returns the raw hash of the word with c inserted
+        // before position i (or at the end, if i is the length).
+        std::uint64_t inserted(std::string::size_type i, char c) const noexcept;
+
+        // deleted() returns the raw hash of the word without the character
+        // at position i.
+        std::uint64_t deleted(std::string::size_type i) const noexcept;
+
+        // replaced() returns the raw hash of the word with the character at
+        // position i replaced by c.
+        std::uint64_t replaced(std::string::size_type i, char c) const noexcept;
+
+    private:
+        const std::string& word;
+
+        // prefixes[i] is the raw hash of the first i characters, and
+        // powers[i] is B^i
+        std::vector<std::uint64_t> prefixes;
+        std::vector<std::uint64_t> powers;
+    };
+
+
+private:
+    static constexpr std::uint64_t MODULUS = (std::uint64_t{1} << 61) - 1;
+    static constexpr std::uint64_t BASE = 0x1F3D5B79A1ULL;
+
+    static std::uint64_t add(std::uint64_t a, std::uint64_t b) noexcept;
+    static std::uint64_t subtract(std::uint64_t a, std::uint64_t b) noexcept;
+    static std::uint64_t multiply(std::uint64_t a, std::uint64_t b) noexcept;
+    static std::uint64_t character(char c) noexcept;
+};
+
+
+
+#endif // POLYNOMIALHASH_HPP
@@ -0,0 +1,246 @@
+// ReplicatedSet.cpp
+//
+// ICS 46 Spring 2018
+// Project #4: Set the Controls for the Heart of the Sun
+
+#include "ReplicatedSet.hpp"
+
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+
+
+namespace
+{
+    // Each word is stored in the pool as its length followed by its
+    // characters, padded so that the next length is aligned.
+    constexpr std::size_t LENGTH_BYTES = sizeof(std::uint32_t);
+
+
+    std::size_t entryBytes(std::size_t length) noexcept
+    {
+        return (LENGTH_BYTES + length + LENGTH_BYTES - 1) / LENGTH_BYTES * LENGTH_BYTES;
+    }
+
+
+    // copyOnNode() runs on a thread pinned to the given node, so that the
+    // replica's pages are written (and, if mbind() wasn't available, first
+    // touched) from the node that will read them.
+    void copyOnNode(unsigned int node, void* target, const std::vector<char>& image)
+    {
+        pinToNode(node);
+        std::memcpy(target, image.data(), image.size());
+    }
+}
+
+
+
+ReplicatedSet::ReplicatedSet(const std::vector<std::string>& words)
+    : ReplicatedSet{words, Options{}}
+{
+}
+
+
+ReplicatedSet::ReplicatedSet(const std::vector<std::string>& words, Options options)
+    : slotMask{0}, _size{0}
+{
+    // The table has at least twice as many slots as there are words, and a
+    // power of two of them, so a probe sequence is short and wraps with a
+    // mask.
+    std::size_t slotCount = 2;
+    while(slotCount < 2 * words.size()) {
+        slotCount *= 2;
+    }
+
+    std::size_t imageBytes = slotCount * sizeof(Slot);
+    for(const std::string& word : words) {
+        imageBytes += entryBytes(word.size());
+    }
+
+    if(imageBytes > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::length_error{"ReplicatedSet: too many words"};
+    }
+
+    // The set is laid out once, here, and then copied to each replica.
+    std::vector<char> image(imageBytes);
+    Slot* slots = reinterpret_cast<Slot*>(image.data());
+    std::size_t poolEnd = slotCount * sizeof(Slot);
+    slotMask = static_cast<std::uint32_t>(slotCount - 1);
+
+    for(const std::string& word : words) {
+        std::uint32_t hash = hashOf(word.data(), word.size());
+        std::uint32_t i = hash & slotMask;
+        bool duplicate = false;
+
+        while(slots[i].offset != 0) {
+            if(slots[i].hash == hash) {
+                const char* entry = image.data() + slots[i].offset;
+                std::uint32_t length;
+                std::memcpy(&length, entry, LENGTH_BYTES);
+
+                if(length == word.size() && std::memcmp(entry + LENGTH_BYTES, word.data(), length) == 0) {
+                    duplicate = true;
+                    break;
+                }
+            }
+
+            i = (i + 1) & slotMask;
+        }
+
+        if(duplicate) {
+            continue;
+        }
+
+        std::uint32_t length = static_cast<std::uint32_t>(word.size());
+        std::memcpy(image.data() + poolEnd, &length, LENGTH_BYTES);
+        std::memcpy(image.data() + poolEnd + LENGTH_BYTES, word.data(), length);
+
+        slots[i].hash = hash;
+        slots[i].offset = static_cast<std::uint32_t>(poolEnd);
+        poolEnd += entryBytes(length);
+        _size++;
+    }
+
+    image.resize(poolEnd);
+
+    // One replica per node that has CPUs (a node can have memory but no
+    // CPUs, and nothing would ever run there to read it).
+    std::vector<unsigned int> nodes;
+    if(options.replicate) {
+        unsigned int nodeCount = numaNodeCount();
+        for(unsigned int node = 0; node < nodeCount; node++) {
+            std::vector<unsigned int> cpus = cpusOfNode(node);
+            if(cpus.empty()) {
+                continue;
+            }
+
+            for(unsigned int cpu : cpus) {
+                if(cpu >= replicaOfCpu.size()) {
+                    replicaOfCpu.resize(cpu + 1, 0);
+                }
+                replicaOfCpu[cpu] = static_cast<unsigned int>(nodes.size());
+            }
+
+            nodes.push_back(node);
+        }
+    }
+
+    if(nodes.size() <= 1) {
+        replicaOfCpu.clear();
+        replicas.emplace_back(image.size(), options.hugePages);
+        std::memcpy(replicas[0].data(), image.data(), image.size());
+        return;
+    }
+
+    for(unsigned int node : nodes) {
+        replicas.emplace_back(image.size(), options.hugePages, static_cast<int>(node));
+    }
+
+    // The copies are made on their own threads, rather than through
+    // parallelFor(), because that would run one of them on (and so pin)
+    // the calling thread.
+    std::vector<std::thread> threads;
+    for(unsigned int r = 0; r < nodes.size(); r++) {
+        threads.emplace_back(copyOnNode, nodes[r], replicas[r].data(), std::cref(image));
+    }
+
+    for(std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+
+bool ReplicatedSet::isImplemented() const noexcept
+{
+    return true;
+}
+
+
+void ReplicatedSet::add(const std::string& element)
+{
+    (void)element;
+    throw std::logic_error{"ReplicatedSet: cannot add to a read-only set"};
+}
+
+
+bool ReplicatedSet::contains(const std::string& element) const
+{
+    const char* replica = replicaForThisThread();
+    const Slot* slots = reinterpret_cast<const Slot*>(replica);
+
+    std::uint32_t hash = hashOf(element.data(), element.size());
+
+    for(std::uint32_t i = hash & slotMask; slots[i].offset != 0; i = (i + 1) & slotMask) {
+        if(slots[i].hash != hash) {
+            continue;
+        }
+
+        const char* entry = replica + slots[i].offset;
+        std::uint32_t length;
+        std::memcpy(&length, entry, LENGTH_BYTES);
+
+        if(length == element.size() && std::memcmp(entry + LENGTH_BYTES, element.data(), length) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+unsigned int ReplicatedSet::size() const noexcept
+{
+    return _size;
+}
+
+
+unsigned int ReplicatedSet::replicaCount() const noexcept
+{
+    return static_cast<unsigned int>(replicas.size());
+}
+
+
+HugePageRegion::Backing ReplicatedSet::backing() const noexcept
+{
+    return replicas[0].backing();
+}
+
+
+std::size_t ReplicatedSet::memoryUsage() const noexcept
+{
+    std::size_t bytes = 0;
+    for(const HugePageRegion& replica : replicas) {
+        bytes += replica.size();
+    }
+    return bytes;
+}
+
+
+const char* ReplicatedSet::replicaForThisThread() const noexcept
+{
+    if(replicaOfCpu.empty()) {
+        return static_cast<const char*>(replicas[0].data());
+    }
+
+    // A thread that isn't pinned can move to another node between this and
+    // the lookup; it still gets the right answer, only from farther away.
+    int cpu = currentCpu();
+    unsigned int r = cpu >= 0 && static_cast<unsigned int>(cpu) < replicaOfCpu.size() ? replicaOfCpu[cpu] : 0;
+    return static_cast<const char*>(replicas[r].data());
+}
+
+
+std::uint32_t ReplicatedSet::hashOf(const char* characters, std::size_t length) noexcept
+{
+    // 64-bit FNV-1a, folded to 32 bits so that the high bits (which the
+    // last few characters affect most) reach the slot index
+    std::uint64_t hash = 14695981039346656037ULL;
+    for(std::size_t i = 0; i < length; i++) {
+        hash ^= static_cast<unsigned char>(characters[i]);
+        hash *= 1099511628211ULL;
+    }
+    return static_cast<std::uint32_t>(hash ^ (hash >> 32));
+}
@@ -0,0 +1,114 @@
+// ReplicatedSet.hpp
+//
+// ICS 46 Spring 2018
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// A ReplicatedSet is a read-only Set of words laid out for lookups from
+// many threads on a machine with several NUMA nodes.  The whole set -- an
+// open-addressing table of (hash, offset) slots followed by a pool holding
+// the words' characters -- lives in one block of memory with no pointers
+// in it, so it can be copied byte for byte.  There is one copy ("replica")
+// per NUMA node, placed on that node, and each lookup goes to the replica
+// of the node whose CPU the calling thread is running on, so no lookup
+// has to reach across to another socket's memory.  Each replica is also
+// backed by 2 MB huge pages when it can be (see HugePageRegion), so a
+// lookup that lands anywhere in a large table rarely misses the TLB.
+//
+// The words are given to the constructor, which lays out the set once and
+// then copies it onto each node from a thread pinned to that node.  add()
+// throws a std::logic_error.
+//
+// You are permitted to use the C++ Standard Library in this class.
+
+#ifndef REPLICATEDSET_HPP
+#define REPLICATEDSET_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "NumaMemory.hpp"
+#include "Set.hpp"
+
+
+
+class ReplicatedSet : public Set<std::string>
+{
+public:
+    struct Options
+    {
+        // whether to ask for huge pages
+        bool hugePages = true;
+
+        // whether to make one replica per NUMA node, rather than just one
+        bool replicate = true;
+    };
+
+public:
+    // Initializes a ReplicatedSet holding the given words (duplicates are
+    // stored once).  It throws a std::length_error if the set would need
+    // more than 4 GB.
+    explicit ReplicatedSet(const std::vector<std::string>& words);
+    ReplicatedSet(const std::vector<std::string>& words, Options options);
+
+    ReplicatedSet(const ReplicatedSet& s) = delete;
+    ReplicatedSet& operator=(const ReplicatedSet& s) = delete;
+
+
+    // isImplemented() returns true, since a ReplicatedSet is implemented.
+    virtual bool isImplemented() const noexcept override;
+
+
+    // add() throws a std::logic_error, since a ReplicatedSet can't be
+    // changed after it's built.
+    virtual void add(const std::string& element) override;
+
+
+    // contains() returns true if the given word is in the set, false
+    // otherwise, looking it up in the replica on the caller's node.
+    virtual bool contains(const std::string& element) const override;
+
+
+    // size() returns the number of words in the set.
+    virtual unsigned int size() const noexcept override;
+
+
+    // replicaCount() returns the number of replicas, which is the number of
+    // NUMA nodes (or 1, if replication was turned off).
+    unsigned int replicaCount() const noexcept;
+
+
+    // backing() returns how the replicas' memory was allocated.
+    HugePageRegion::Backing backing() const noexcept;
+
+
+    // memoryUsage() returns the number of bytes in all of the replicas.
+    std::size_t memoryUsage() const noexcept;
+
+
+private:
+    struct Slot
+    {
+        std::uint32_t hash;
+
+        // where the word's entry in the pool begins, counting from the
+        // start of the replica, or 0 if the slot is empty
+        std::uint32_t offset;
+    };
+
+    std::vector<HugePageRegion> replicas;
+
+    // the replica to use for each CPU
+    std::vector<unsigned int> replicaOfCpu;
+
+    std::uint32_t slotMask;
+    unsigned int _size;
+
+    const char* replicaForThisThread() const noexcept;
+
+    static std::uint32_t hashOf(const char* characters, std::size_t length) noexcept;
+};
+
+
+
+#endif // REPLICATEDSET_HPP
@@ -0,0 +1,309 @@
+// RingBuffer.hpp
+//
+// ICS 46 Spring 2018
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// A RingBuffer is a bounded queue that any number of threads can push
+// onto and pop from at once without locking (Dmitry Vyukov's bounded
+// multi-producer, multi-consumer queue).  Each cell of the ring carries a
+// sequence number saying whose turn it is: a producer claims a position
+// with a compare-and-swap on the enqueue position, writes the element, and
+// then publishes it by advancing the cell's sequence; consumers do the
+// same on the dequeue position.  Producers and consumers only contend with
+// each other over a cell when the queue is nearly empty or nearly full.
+//
+// tryPush() and tryPop() never wait.  push() and pop() wait (spinning
+// briefly, then yielding, then sleeping) for room or for an element, so a
+// full queue holds back the threads feeding it, and the memory in flight
+// stays bounded by the capacity.  close() marks the end of the stream:
+// pop() returns false once a closed queue is empty, and push() returns
+// false on a closed queue rather than wait for room that may never come.
+//
+// ElementType must be default-constructible and movable.
+//
+// You are permitted to use the C++ Standard Library in this class.
+
+#ifndef RINGBUFFER_HPP
+#define RINGBUFFER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+
+
+template <typename ElementType>
+class RingBuffer
+{
+public:
+    // Initializes an empty RingBuffer that holds at least the given number
+    // of elements (rounded up to a power of two, and to at least 2).
+    explicit RingBuffer(unsigned int capacity);
+
+    ~RingBuffer() noexcept;
+
+    RingBuffer(const RingBuffer& r) = delete;
+    RingBuffer& operator=(const RingBuffer& r) = delete;
+
+
+    // tryPush() moves an element onto the queue and returns true, or returns
+    // false (leaving the element alone) if the queue is full.
+    bool tryPush(ElementType&& element);
+
+
+    // tryPop() moves the oldest element off the queue into "element" and
+    // returns true, or returns false if the queue is empty.
+    bool tryPop(ElementType& element);
+
+
+    // push() waits until there's room and then pushes an element, returning
+    // true, or returns false if the queue is (or becomes) closed.
+    bool push(ElementType&& element);
+
+
+    // pop() waits until there's an element and then pops it, returning true,
+    // or returns false once the queue is closed and empty.
+    bool pop(ElementType& element);
+
+
+    // close() marks the end of the stream.  Elements already pushed can
+    // still be popped.
+    void close() noexcept;
+
+    bool closed() const noexcept;
+
+
+    // depth() returns the number of elements in the queue.  While other
+    // threads are pushing and popping, it's only a snapshot.
+    unsigned int depth() const noexcept;
+
+    unsigned int capacity() const noexcept;
+
+
+private:
+    struct Cell
+    {
+        std::atomic<std::size_t> sequence;
+        ElementType element;
+    };
+
+    // A Backoff waits a little longer each time it's asked to: first by
+    // spinning, then by yielding the processor, and then by sleeping, so a
+    // thread waiting on a queue doesn't starve the thread that would make
+    // progress on it.
+    class Backoff
+    {
+    public:
+        Backoff() noexcept;
+        void wait() noexcept;
+
+    private:
+        unsigned int rounds;
+    };
+
+    Cell* cells;
+    std::size_t mask;
+
+    // the positions are kept on cache lines of their own, so producers and
+    // consumers don't slow each other down by sharing one
+    alignas(64) std::atomic<std::size_t> enqueuePosition;
+    alignas(64) std::atomic<std::size_t> dequeuePosition;
+    alignas(64) std::atomic<bool> isClosed;
+};
+
+
+
+template <typename ElementType>
+RingBuffer<ElementType>::RingBuffer(unsigned int capacity)
+    : cells{NULL}, mask{0}, enqueuePosition{0}, dequeuePosition{0}, isClosed{false}
+{
+    std::size_t size = 2;
+    while(size < capacity) {
+        size *= 2;
+    }
+
+    cells = new Cell[size];
+    mask = size - 1;
+
+    for(std::size_t i = 0; i < size; i++) {
+        cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+
+template <typename ElementType>
+RingBuffer<ElementType>::~RingBuffer() noexcept
+{
+    delete[] cells;
+}
+
+
+template <typename ElementType>
+bool RingBuffer<ElementType>::tryPush(ElementType&& element)
+{
+    std::size_t position = enqueuePosition.load(std::memory_order_relaxed);
+
+    while(true) {
+        Cell& cell = cells[position & mask];
+        std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+
+        if(difference == 0) {
+            // the cell is free for this position; claim the position
+            if(enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                cell.element = std::move(element);
+                cell.sequence.store(position + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if(difference < 0) {
+            // the cell still holds the element from one lap ago
+            return false;
+        }
+        else {
+            // another producer claimed this position first
+            position = enqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+
+template <typename ElementType>
+bool RingBuffer<ElementType>::tryPop(ElementType& element)
+{
+    std::size_t position = dequeuePosition.load(std::memory_order_relaxed);
+
+    while(true) {
+        Cell& cell = cells[position & mask];
+        std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+
+        if(difference == 0) {
+            if(dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                element = std::move(cell.element);
+
+                // hand the cell to the producer one lap ahead
+                cell.sequence.store(position + mask + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if(difference < 0) {
+            // nothing has been published at this position yet
+            return false;
+        }
+        else {
+            position = dequeuePosition.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+
+template <typename ElementType>
+bool RingBuffer<ElementType>::push(ElementType&& element)
+{
+    Backoff backoff;
+
+    while(!closed()) {
+        if(tryPush(std::move(element))) {
+            return true;
+        }
+        backoff.wait();
+    }
+
+    return false;
+}
+
+
+template <typename ElementType>
+bool RingBuffer<ElementType>::pop(ElementType& element)
+{
+    Backoff backoff;
+
+    while(true) {
+        if(tryPop(element)) {
+            return true;
+        }
+
+        // every push happened before the close, so once the queue is seen
+        // to be closed, one more try finds anything that's left
+        if(closed()) {
+            return tryPop(element);
+        }
+
+        backoff.wait();
+    }
+}
+
+
+template <typename ElementType>
+void RingBuffer<ElementType>::close() noexcept
+{
+    isClosed.store(true, std::memory_order_release);
+}
+
+
+template <typename ElementType>
+bool RingBuffer<ElementType>::closed() const noexcept
+{
+    return isClosed.load(std::memory_order_acquire);
+}
+
+
+template <typename ElementType>
+unsigned int RingBuffer<ElementType>::depth() const noexcept
+{
+    std::size_t dequeued = dequeuePosition.load(std::memory_order_relaxed);
+    std::size_t enqueued = enqueuePosition.load(std::memory_order_relaxed);
+
+    if(enqueued <= dequeued) {
+        return 0;
+    }
+    return static_cast<unsigned int>(enqueued - dequeued > mask + 1 ? mask + 1 : enqueued - dequeued);
+}
+
+
+template <typename ElementType>
+unsigned int RingBuffer<ElementType>::capacity() const noexcept
+{
+    return static_cast<unsigned int>(mask + 1);
+}
+
+
+template <typename ElementType>
+RingBuffer<ElementType>::Backoff::Backoff() noexcept
+    : rounds{0}
+{
+}
+
+
+template <typename ElementType>
+void RingBuffer<ElementType>::Backoff::wait() noexcept
+{
+    if(rounds < 16) {
+        for(unsigned int i = 0; i < (1u << (rounds / 4)); i++) {
+#if defined(__SSE2__)
+            _mm_pause();
+#endif
+        }
+    }
+    else if(rounds < 64) {
+        std::this_thread::yield();
+    }
+    else {
+        std::this_thread::sleep_for(std::chrono::microseconds{50});
+    }
+
+    if(rounds < 64) {
+        rounds++;
+    }
+}
+
+
+
+#endif // RINGBUFFER_HPP
@@ -0,0 +1,55 @@
+// SuggestionBudget.cpp
+//
+// ICS 46 Spring 2018
+// Project #4: Set the Controls for the Heart of the Sun
+
+#include "SuggestionBudget.hpp"
+
+
+
+ProbeBudget::ProbeBudget(const SuggestionBudget& budget)
+    : budget{budget}, made{0}, stopped{false}
+{
+}
+
+
+bool ProbeBudget::allow()
+{
+    if(stopped) {
+        return false;
+    }
+
+    if(made >= budget.maxProbes) {
+        stopped = true;
+    }
+    else if(made % CHECK_INTERVAL == 0) {
+        // the clock and the flag cost more than a probe's bookkeeping, so
+        // they're only checked every so often
+        if(budget.cancelled != NULL && budget.cancelled->load(std::memory_order_relaxed)) {
+            stopped = true;
+        }
+        else if(budget.deadline != std::chrono::steady_clock::time_point::max()
+            && std::chrono::steady_clock::now() >= budget.deadline) {
+            stopped = true;
+        }
+    }
+
+    if(stopped) {
+        return false;
+    }
+
+    made++;
+    return true;
+}
+
+
+bool ProbeBudget::exhausted() const noexcept
+{
+    return stopped;
+}
+
+
+unsigned int ProbeBudget::probes() const noexcept
+{
+    return made;
+}
@@ -0,0 +1,101 @@
+// SuggestionBudget.hpp
+//
+// ICS 46 Spring 2018
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// A SuggestionBudget limits how much work finding the suggestions for a
+// word may do, and a ProbeBudget counts the lookups ("probes") made against
+// one as they happen.  The techniques of a BasicWordChecker are written in
+// terms of a probe policy -- any type with the member functions allow() and
+// exhausted() that a ProbeBudget has -- so the same code runs with a budget
+// and without one.  Without one, the policy is UnlimitedProbes, whose
+// functions are constants that the compiler optimizes away.
+//
+// You are permitted to use the C++ Standard Library in this class.
+
+#ifndef SUGGESTIONBUDGET_HPP
+#define SUGGESTIONBUDGET_HPP
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <string>
+#include <vector>
+
+
+
+// A SuggestionBudget can give a deadline, a maximum number of probes in the
+// word set, and a flag that another thread can set to cancel the call.  Any
+// of these can be left at its default, which imposes no limit.
+struct SuggestionBudget
+{
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+    unsigned int maxProbes = UINT_MAX;
+    const std::atomic<bool>* cancelled = NULL;
+};
+
+
+// A SuggestionResult holds the suggestions found within a budget, whether
+// the budget ran out before every technique had finished (in which case
+// the suggestions are only the ones found so far), and how many probes
+// were made.
+struct SuggestionResult
+{
+    std::vector<std::string> suggestions;
+    bool truncated = false;
+    unsigned int probes = 0;
+};
+
+
+
+class ProbeBudget
+{
+public:
+    // The clock and the cancellation flag are checked every CHECK_INTERVAL
+    // probes.
+    static constexpr unsigned int CHECK_INTERVAL = 16;
+
+public:
+    // Initializes a ProbeBudget that counts probes against the given
+    // SuggestionBudget, which must outlive it.
+    explicit ProbeBudget(const SuggestionBudget& budget);
+
+
+    // allow() returns true if one more probe may be made, counting it, or
+    // false if the budget has run out.
+    bool allow();
+
+
+    // exhausted() returns true once allow() has returned false.
+    bool exhausted() const noexcept;
+
+
+    // probes() returns the number of probes that allow() has allowed.
+    unsigned int probes() const noexcept;
+
+
+private:
+    const SuggestionBudget& budget;
+    unsigned int made;
+    bool stopped;
+};
+
+
+
+// UnlimitedProbes is the probe policy that allows every probe.
+struct UnlimitedProbes
+{
+    bool allow() const noexcept
+    {
+        return true;
+    }
+
+    bool exhausted() const noexcept
+    {
+        return false;
+    }
+};
+
+
+
+#endif // SUGGESTIONBUDGET_HPP
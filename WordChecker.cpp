@@ -7,132 +7,103 @@
 // the requirements.
 
 #include "WordChecker.hpp"
+#include "AVLSet.hpp"
+#include "BasicWordChecker.hpp"
+#include "EytzingerSet.hpp"
+#include "HashSet.hpp"
+#include "LengthPartitionedSet.hpp"
+#include "MultiDictionarySet.hpp"
 
-#include <algorithm>
+#include <typeinfo>
 
-WordChecker::WordChecker(const Set<std::string>& words)
-    : words{words}
-{
-}
 
-bool WordChecker::wordExists(const std::string& word) const
+
+namespace
 {
-    return words.contains(word);
+    // These find the suggestions for a word with a BasicWordChecker
+    // specialized on SetType, which must be the set's concrete type (or
+    // Set<std::string>, for any set).
+
+    template <typename SetType>
+    std::vector<std::string> findSuggestionsIn(const Set<std::string>& words, const std::string& word)
+    {
+        return BasicWordChecker<SetType>{static_cast<const SetType&>(words)}.findSuggestions(word);
+    }
+
+    template <typename SetType>
+    SuggestionResult findSuggestionsWithin(const Set<std::string>& words, const std::string& word, const SuggestionBudget& budget)
+    {
+        return BasicWordChecker<SetType>{static_cast<const SetType&>(words)}.findSuggestions(word, budget);
+    }
+
+
+    template <typename SetType>
+    void specializeOn(
+        std::vector<std::string> (*& find)(const Set<std::string>&, const std::string&),
+        SuggestionResult (*& findWithin)(const Set<std::string>&, const std::string&, const SuggestionBudget&))
+    {
+        find = &findSuggestionsIn<SetType>;
+        findWithin = &findSuggestionsWithin<SetType>;
+    }
 }
 
 
-std::vector<std::string> WordChecker::findSuggestions(const std::string& word) const
-{
-    std::vector<std::string> suggestions;
-
-    findSuggestionsTechnique1(suggestions, word);
-    findSuggestionsTechnique2(suggestions, word);
-    findSuggestionsTechnique3(suggestions, word);
-    findSuggestionsTechnique4(suggestions, word);
-    findSuggestionsTechnique5(suggestions, word);
 
-    return suggestions;
+WordChecker::WordChecker(const Set<std::string>& words)
+    : words{words}, phonetic{NULL}, findSpecializedSuggestions{NULL}, findSpecializedSuggestionsWithin{NULL}
+{
+    // the types must match exactly, since a BasicWordChecker's calls to
+    // contains() would skip the override in a derived class
+    const std::type_info& type = typeid(words);
+
+    if(type == typeid(HashSet<std::string>)) {
+        specializeOn<HashSet<std::string>>(findSpecializedSuggestions, findSpecializedSuggestionsWithin);
+    }
+    else if(type == typeid(AVLSet<std::string>)) {
+        specializeOn<AVLSet<std::string>>(findSpecializedSuggestions, findSpecializedSuggestionsWithin);
+    }
+    else if(type == typeid(EytzingerSet<std::string>)) {
+        specializeOn<EytzingerSet<std::string>>(findSpecializedSuggestions, findSpecializedSuggestionsWithin);
+    }
+    else if(type == typeid(LengthPartitionedSet)) {
+        specializeOn<LengthPartitionedSet>(findSpecializedSuggestions, findSpecializedSuggestionsWithin);
+    }
+    else if(type == typeid(MultiDictionarySet::View)) {
+        specializeOn<MultiDictionarySet::View>(findSpecializedSuggestions, findSpecializedSuggestionsWithin);
+    }
+    else {
+        specializeOn<Set<std::string>>(findSpecializedSuggestions, findSpecializedSuggestionsWithin);
+    }
 }
 
-void WordChecker::findSuggestionsTechnique1(std::vector<std::string> &suggestions, std::string word) const
+WordChecker::WordChecker(const Set<std::string>& words, const PhoneticIndex& phonetic)
+    : WordChecker{words}
 {
-	for(int i = 0; i < word.size()-1; i++) 
-	{
-		// swap characters
-		std::swap(word[i], word[i+1]);
-
-		// if word exists add it to suggestions
-		if(wordExists(word))
-		{
-			suggestions.push_back(word);
-		}
-
-		//swap characters back
-		std::swap(word[i], word[i+1]);
-	}
+    this->phonetic = &phonetic;
 }
 
-void WordChecker::findSuggestionsTechnique2(std::vector<std::string> &suggestions, std::string word) const
+bool WordChecker::wordExists(const std::string& word) const
 {
-	for(int i = 0; i < word.size()+1; i++) 
-	{
-		for(char c = 'A'; c <= 'Z'; c++)
-		{
-			// insert char
-			word.insert(i, 1, c);
-
-			// if word exists add it to suggestions
-			if(wordExists(word))
-			{
-				suggestions.push_back(word);
-			}
-
-			//delete inserted char
-			word.erase(i, 1);
-		}
-	}	
+    return words.contains(word);
 }
 
-void WordChecker::findSuggestionsTechnique3(std::vector<std::string> &suggestions, std::string word) const
+
+std::vector<std::string> WordChecker::findSuggestions(const std::string& word) const
 {
-	for(int i = 0; i < word.size(); i++) 
-	{
-		// first save char
-		char c = word[i];
-
-		// delete char
-		word.erase(i, 1);
-
-		// if word exists add it to suggestions
-		if(wordExists(word))
-		{
-			suggestions.push_back(word);
-		}
-
-		//insert char back
-		word.insert(i, 1, c);
-	}	
+    return findSpecializedSuggestions(words, word);
 }
 
-void WordChecker::findSuggestionsTechnique4(std::vector<std::string> &suggestions, std::string word) const
+
+SuggestionResult WordChecker::findSuggestions(const std::string& word, const SuggestionBudget& budget) const
 {
-	for(int i = 0; i < word.size(); i++) 
-	{
-		// first saved the char
-		char saved = word[i];
-		word.erase(i, 1);
-
-		for(char c = 'A'; c <= 'Z'; c++)
-		{
-			// insert char
-			word.insert(i, 1, c);
-
-			// if word exists add it to suggestions
-			if(wordExists(word))
-			{
-				suggestions.push_back(word);
-			}
-
-			//delete inserted char
-			word.erase(i, 1);
-		}
-
-		// insert char back
-		word.insert(i, 1, saved);
-	}	
+    return findSpecializedSuggestionsWithin(words, word, budget);
 }
 
-void WordChecker::findSuggestionsTechnique5(std::vector<std::string> &suggestions, std::string word) const
+
+std::vector<std::string> WordChecker::findSoundAlikeSuggestions(const std::string& word) const
 {
-	for(int i = 1; i < word.size(); i++)
-	{
-		std::string left = word.substr(0, i);
-		std::string right = word.substr(i, word.size() - i);
-
-		// if words exists add it to suggestions
-		if(wordExists(left) && wordExists(right))
-		{
-			suggestions.push_back(left + " " + right);
-		}		
-	}
-}
\ No newline at end of file
+    if(phonetic == NULL) {
+        return {};
+    }
+    return phonetic->soundAlikes(word);
+}
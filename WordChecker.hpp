@@ -18,7 +18,9 @@
 
 #include <string>
 #include <vector>
+#include "PhoneticIndex.hpp"
 #include "Set.hpp"
+#include "SuggestionBudget.hpp"
 
 
 
@@ -27,9 +29,19 @@ class WordChecker
 public:
     // The constructor requires a Set of words to be passed into it.  The
     // WordChecker will store a reference to a const Set, which it will use
-    // whenever it needs to look up a word.
+    // whenever it needs to look up a word.  The suggestions are found by a
+    // BasicWordChecker: one specialized on the set's type if it's a
+    // HashSet, an AVLSet, an EytzingerSet, a LengthPartitionedSet or a
+    // MultiDictionarySet::View, so that its lookups aren't virtual calls
+    // and it can take advantage of what the set offers (see
+    // BasicWordChecker.hpp), or one for any Set if it isn't.
     WordChecker(const Set<std::string>& words);
 
+    // This constructor also takes a PhoneticIndex of the same words, which
+    // findSoundAlikeSuggestions() will use.  The WordChecker stores a
+    // reference to it, too.
+    WordChecker(const Set<std::string>& words, const PhoneticIndex& phonetic);
+
 
     // wordExists() returns true if the given word is spelled correctly,
     // false otherwise.
@@ -42,36 +54,39 @@ public:
     std::vector<std::string> findSuggestions(const std::string& word) const;
 
 
+    // This version of findSuggestions() stops as soon as the given budget
+    // runs out.  So that the suggestions found by then are the most likely
+    // ones, it runs the techniques from cheapest to most expensive: swaps
+    // (n - 1 probes for a word of n letters), deletions (n), splits (up to
+    // 2n), replacements (26n), and finally insertions (26n + 26).  The clock
+    // and the cancellation flag are checked every CHECK_INTERVAL probes.
+    SuggestionResult findSuggestions(const std::string& word, const SuggestionBudget& budget) const;
+
+    static constexpr unsigned int CHECK_INTERVAL = ProbeBudget::CHECK_INTERVAL;
+
+
+    // findSoundAlikeSuggestions() returns the words that sound like the
+    // given word according to the PhoneticIndex given to the constructor,
+    // using one lookup in the index.  These are words that the five
+    // techniques can't find, such as "PHOTOGRAPH" for "FOTOGRAF".  If the
+    // WordChecker wasn't given an index, it returns no suggestions.
+    std::vector<std::string> findSoundAlikeSuggestions(const std::string& word) const;
+
+
 private:
     const Set<std::string>& words;
 
-    // find suggestion by swapping each adjacent pair of characters in the word.
-    // add suggestions into vector passed in as parameter
-    void findSuggestionsTechnique1(std::vector<std::string> &suggestions, std::string word) const;
-
-    // find suggestion by following technique:
-    // In between each adjacent pair of characters in the word (also before the first character and after the last character), each letter from 'A' through 'Z' is inserted.
-    // add suggestions into vector passed in as parameter
-    void findSuggestionsTechnique2(std::vector<std::string> &suggestions, std::string word) const;
-
-    // find suggestion by following technique:
-    // Deleting each character from the word.
-    // add suggestions into vector passed in as parameter
-    void findSuggestionsTechnique3(std::vector<std::string> &suggestions, std::string word) const;
-
-    // find suggestion by following technique:
-    // Replacing each character in the word with each letter from 'A' through 'Z'.
-    // add suggestions into vector passed in as parameter
-    void findSuggestionsTechnique4(std::vector<std::string> &suggestions, std::string word) const;
-
-    // find suggestion by following technique:
-    // Splitting the word into a pair of words by adding a space in between each adjacent pair of characters in the word. 
-    // It should be noted that this will only generate a suggestion if both words in the pair are found in the word set
-    // add suggestions into vector passed in as parameter
-    void findSuggestionsTechnique5(std::vector<std::string> &suggestions, std::string word) const;
+    // the index of the same words by sound, or NULL if there isn't one
+    const PhoneticIndex* phonetic;
+
+    // the two versions of findSuggestions() hand the word to these
+    // functions, which use a BasicWordChecker specialized on the set's
+    // concrete type
+    std::vector<std::string> (*findSpecializedSuggestions)(const Set<std::string>& words, const std::string& word);
+    SuggestionResult (*findSpecializedSuggestionsWithin)(
+        const Set<std::string>& words, const std::string& word, const SuggestionBudget& budget);
 };
 
 
 
 #endif // WORDCHECKER_HPP
-
@@ -0,0 +1,318 @@
+// WordCheckerStats.cpp
+//
+// ICS 46 Spring 2018
+// Project #4: Set the Controls for the Heart of the Sun
+
+#include "WordCheckerStats.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <mutex>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+
+
+namespace
+{
+    // Each thread's counters.  Only the owning thread writes them, so an
+    // update is a relaxed load and store rather than a locked add; the
+    // atomics are there so that snapshot() can read them while they change.
+    struct ThreadCounters
+    {
+        struct Cell
+        {
+            std::atomic<std::uint64_t> calls{0};
+            std::atomic<std::uint64_t> ticks{0};
+            std::atomic<std::uint64_t> probes{0};
+            std::atomic<std::uint64_t> hits{0};
+            std::atomic<std::uint64_t> histogram[WordCheckerStats::TIME_BUCKETS];
+
+            Cell()
+            {
+                for(std::atomic<std::uint64_t>& bucket : histogram) {
+                    bucket.store(0, std::memory_order_relaxed);
+                }
+            }
+        };
+
+        Cell cells[WordCheckerStats::TECHNIQUE_COUNT][WordCheckerStats::LENGTH_BUCKETS];
+        std::atomic<std::uint64_t> probes{0};
+
+        ThreadCounters* next = NULL;
+        ThreadCounters* previous = NULL;
+
+        ThreadCounters();
+        ~ThreadCounters();
+    };
+
+
+    void bump(std::atomic<std::uint64_t>& counter, std::uint64_t amount) noexcept
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+
+    void addInto(WordCheckerStats::Counters& total, const ThreadCounters::Cell& cell) noexcept
+    {
+        total.calls += cell.calls.load(std::memory_order_relaxed);
+        total.ticks += cell.ticks.load(std::memory_order_relaxed);
+        total.probes += cell.probes.load(std::memory_order_relaxed);
+        total.hits += cell.hits.load(std::memory_order_relaxed);
+        for(unsigned int b = 0; b < WordCheckerStats::TIME_BUCKETS; b++) {
+            total.histogram[b] += cell.histogram[b].load(std::memory_order_relaxed);
+        }
+    }
+
+
+    // The registry of live threads' counters, plus the totals of the
+    // threads that have exited, and the clock readings used to work out
+    // the tick rate.
+    struct Registry
+    {
+        std::mutex mutex;
+        ThreadCounters* threads = NULL;
+        WordCheckerStats::Counters exited[WordCheckerStats::TECHNIQUE_COUNT][WordCheckerStats::LENGTH_BUCKETS];
+
+        std::uint64_t startTicks = WordCheckerStats::now();
+        std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    };
+
+
+    Registry& registry()
+    {
+        static Registry instance;
+        return instance;
+    }
+
+
+    ThreadCounters::ThreadCounters()
+    {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock{r.mutex};
+
+        next = r.threads;
+        if(next != NULL) {
+            next->previous = this;
+        }
+        r.threads = this;
+    }
+
+
+    ThreadCounters::~ThreadCounters()
+    {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock{r.mutex};
+
+        for(unsigned int t = 0; t < WordCheckerStats::TECHNIQUE_COUNT; t++) {
+            for(unsigned int l = 0; l < WordCheckerStats::LENGTH_BUCKETS; l++) {
+                addInto(r.exited[t][l], cells[t][l]);
+            }
+        }
+
+        if(previous != NULL) {
+            previous->next = next;
+        }
+        else {
+            r.threads = next;
+        }
+        if(next != NULL) {
+            next->previous = previous;
+        }
+    }
+
+
+    ThreadCounters& threadCounters()
+    {
+        thread_local ThreadCounters counters;
+        return counters;
+    }
+
+
+    unsigned int timeBucket(std::uint64_t ticks) noexcept
+    {
+        unsigned int bucket = 0;
+        while(ticks != 0 && bucket + 1 < WordCheckerStats::TIME_BUCKETS) {
+            ticks >>= 1;
+            bucket++;
+        }
+        return bucket;
+    }
+}
+
+
+
+std::uint64_t WordCheckerStats::Counters::percentileTicks(double fraction) const noexcept
+{
+    std::uint64_t wanted = static_cast<std::uint64_t>(fraction * calls);
+    std::uint64_t seen = 0;
+
+    for(unsigned int b = 0; b < TIME_BUCKETS; b++) {
+        seen += histogram[b];
+        if(seen > wanted || (seen == calls && seen != 0)) {
+            return b == 0 ? 0 : std::uint64_t{1} << b;
+        }
+    }
+    return 0;
+}
+
+
+WordCheckerStats::Snapshot::Snapshot()
+    : tickRate{0.0}
+{
+}
+
+
+const WordCheckerStats::Counters& WordCheckerStats::Snapshot::at(unsigned int technique, unsigned int length) const noexcept
+{
+    if(length >= LENGTH_BUCKETS) {
+        length = LENGTH_BUCKETS - 1;
+    }
+    return counters[technique - 1][length];
+}
+
+
+WordCheckerStats::Counters WordCheckerStats::Snapshot::total(unsigned int technique) const noexcept
+{
+    Counters sum;
+    for(unsigned int l = 0; l < LENGTH_BUCKETS; l++) {
+        const Counters& c = counters[technique - 1][l];
+        sum.calls += c.calls;
+        sum.ticks += c.ticks;
+        sum.probes += c.probes;
+        sum.hits += c.hits;
+        for(unsigned int b = 0; b < TIME_BUCKETS; b++) {
+            sum.histogram[b] += c.histogram[b];
+        }
+    }
+    return sum;
+}
+
+
+double WordCheckerStats::Snapshot::ticksPerMicrosecond() const noexcept
+{
+    return tickRate;
+}
+
+
+void WordCheckerStats::Snapshot::dump(std::ostream& out) const
+{
+    out << "technique length calls mean_us p50_us p99_us probes hits\n";
+
+    double rate = tickRate > 0.0 ? tickRate : 1.0;
+
+    for(unsigned int t = 0; t < TECHNIQUE_COUNT; t++) {
+        for(unsigned int l = 0; l < LENGTH_BUCKETS; l++) {
+            const Counters& c = counters[t][l];
+            if(c.calls == 0) {
+                continue;
+            }
+
+            out << (t + 1) << ' '
+                << l << (l == LENGTH_BUCKETS - 1 ? "+" : "") << ' '
+                << c.calls << ' '
+                << std::fixed << std::setprecision(3)
+                << c.ticks / rate / c.calls << ' '
+                << c.percentileTicks(0.50) / rate << ' '
+                << c.percentileTicks(0.99) / rate << ' '
+                << c.probes << ' '
+                << c.hits << '\n';
+        }
+    }
+}
+
+
+WordCheckerStats::Scope::Scope(unsigned int technique, std::string::size_type length, const std::vector<std::string>& suggestions) noexcept
+    : technique{technique},
+      length{static_cast<unsigned int>(length < LENGTH_BUCKETS ? length : LENGTH_BUCKETS - 1)},
+      suggestions{suggestions},
+      suggestionsBefore{suggestions.size()},
+      probesBefore{threadCounters().probes.load(std::memory_order_relaxed)},
+      start{now()}
+{
+}
+
+
+WordCheckerStats::Scope::~Scope() noexcept
+{
+    std::uint64_t elapsed = now() - start;
+    ThreadCounters& counters = threadCounters();
+    ThreadCounters::Cell& cell = counters.cells[technique - 1][length];
+
+    bump(cell.calls, 1);
+    bump(cell.ticks, elapsed);
+    bump(cell.probes, counters.probes.load(std::memory_order_relaxed) - probesBefore);
+    bump(cell.hits, suggestions.size() - suggestionsBefore);
+    bump(cell.histogram[timeBucket(elapsed)], 1);
+}
+
+
+WordCheckerStats::Snapshot WordCheckerStats::snapshot()
+{
+    Snapshot result;
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock{r.mutex};
+
+    for(unsigned int t = 0; t < TECHNIQUE_COUNT; t++) {
+        for(unsigned int l = 0; l < LENGTH_BUCKETS; l++) {
+            result.counters[t][l] = r.exited[t][l];
+            for(ThreadCounters* thread = r.threads; thread != NULL; thread = thread->next) {
+                addInto(result.counters[t][l], thread->cells[t][l]);
+            }
+        }
+    }
+
+    double elapsedMicroseconds = std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - r.startTime).count();
+    if(elapsedMicroseconds > 0.0) {
+        result.tickRate = (now() - r.startTicks) / elapsedMicroseconds;
+    }
+
+    return result;
+}
+
+
+void WordCheckerStats::reset()
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock{r.mutex};
+
+    for(unsigned int t = 0; t < TECHNIQUE_COUNT; t++) {
+        for(unsigned int l = 0; l < LENGTH_BUCKETS; l++) {
+            r.exited[t][l] = Counters{};
+
+            // another thread may be bumping these at the same moment, in
+            // which case that one update may survive the reset
+            for(ThreadCounters* thread = r.threads; thread != NULL; thread = thread->next) {
+                ThreadCounters::Cell& cell = thread->cells[t][l];
+                cell.calls.store(0, std::memory_order_relaxed);
+                cell.ticks.store(0, std::memory_order_relaxed);
+                cell.probes.store(0, std::memory_order_relaxed);
+                cell.hits.store(0, std::memory_order_relaxed);
+                for(std::atomic<std::uint64_t>& bucket : cell.histogram) {
+                    bucket.store(0, std::memory_order_relaxed);
+                }
+            }
+        }
+    }
+}
+
+
+void WordCheckerStats::countProbe() noexcept
+{
+    bump(threadCounters().probes, 1);
+}
+
+
+std::uint64_t WordCheckerStats::now() noexcept
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
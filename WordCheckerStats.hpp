@@ -0,0 +1,136 @@
+// WordCheckerStats.hpp
+//
+// ICS 46 Spring 2018
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// WordCheckerStats records how much time each of WordChecker's five
+// suggestion techniques takes, how many lookups ("probes") it makes, and
+// how many suggestions ("hits") it finds, broken down by the length of the
+// word being checked.  Times are read from the CPU's timestamp counter
+// where there is one (and from std::chrono::steady_clock otherwise) and
+// are kept as a histogram with one bucket per power of two.
+//
+// Each thread records into its own counters, so recording never contends
+// with other threads; snapshot() adds up every thread's counters when it's
+// called.  Counters of threads that have exited are folded into a shared
+// total, so nothing is lost when a thread ends.
+//
+// Recording is compiled in only when WORDCHECKER_STATS is defined.  When
+// it isn't, the recording macros below expand to nothing, so the
+// techniques pay nothing at all, and snapshot() always returns zeroes.
+//
+// You are permitted to use the C++ Standard Library in this class.
+
+#ifndef WORDCHECKERSTATS_HPP
+#define WORDCHECKERSTATS_HPP
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+
+
+class WordCheckerStats
+{
+public:
+    static constexpr unsigned int TECHNIQUE_COUNT = 5;
+
+    // Words of LENGTH_BUCKETS - 1 letters or more share the last bucket.
+    static constexpr unsigned int LENGTH_BUCKETS = 32;
+
+    // Time bucket b counts calls that took from 2^(b - 1) up to 2^b ticks.
+    static constexpr unsigned int TIME_BUCKETS = 40;
+
+#if defined(WORDCHECKER_STATS)
+    static constexpr bool enabled = true;
+#else
+    static constexpr bool enabled = false;
+#endif
+
+    // A Counters holds the totals for one technique at one word length.
+    struct Counters
+    {
+        std::uint64_t calls = 0;
+        std::uint64_t ticks = 0;
+        std::uint64_t probes = 0;
+        std::uint64_t hits = 0;
+        std::uint64_t histogram[TIME_BUCKETS] = {};
+
+        // percentileTicks() returns an upper bound on the time, in ticks,
+        // within which the given fraction (e.g., 0.99) of calls finished.
+        std::uint64_t percentileTicks(double fraction) const noexcept;
+    };
+
+    // A Snapshot holds the totals across every thread at one moment.
+    class Snapshot
+    {
+    public:
+        Snapshot();
+
+        // at() returns the counters for a technique (1 through 5) and a
+        // word length.
+        const Counters& at(unsigned int technique, unsigned int length) const noexcept;
+
+        // total() returns the counters for a technique across all lengths.
+        Counters total(unsigned int technique) const noexcept;
+
+        // ticksPerMicrosecond() returns the rate of the clock that the
+        // times were measured with.
+        double ticksPerMicrosecond() const noexcept;
+
+        // dump() writes a table of the nonzero counters.
+        void dump(std::ostream& out) const;
+
+    private:
+        friend class WordCheckerStats;
+
+        Counters counters[TECHNIQUE_COUNT][LENGTH_BUCKETS];
+        double tickRate;
+    };
+
+    // A Scope measures one run of a technique, from its construction to
+    // its destruction.
+    class Scope
+    {
+    public:
+        Scope(unsigned int technique, std::string::size_type length, const std::vector<std::string>& suggestions) noexcept;
+        ~Scope() noexcept;
+
+    private:
+        unsigned int technique;
+        unsigned int length;
+        const std::vector<std::string>& suggestions;
+        std::vector<std::string>::size_type suggestionsBefore;
+        std::uint64_t probesBefore;
+        std::uint64_t start;
+    };
+
+public:
+    // snapshot() adds up the counters of every thread.
+    static Snapshot snapshot();
+
+    // reset() sets every thread's counters back to zero.
+    static void reset();
+
+    // countProbe() counts one lookup made by the calling thread.
+    static void countProbe() noexcept;
+
+    // now() reads the clock that times are measured with.
+    static std::uint64_t now() noexcept;
+};
+
+
+
+#if defined(WORDCHECKER_STATS)
+#define WORDCHECKER_STATS_SCOPE(technique, word, suggestions) \
+    WordCheckerStats::Scope wordCheckerStatsScope{(technique), (word).size(), (suggestions)}
+#define WORDCHECKER_STATS_PROBE() WordCheckerStats::countProbe()
+#else
+#define WORDCHECKER_STATS_SCOPE(technique, word, suggestions) ((void)0)
+#define WORDCHECKER_STATS_PROBE() ((void)0)
+#endif
+
+
+
+#endif // WORDCHECKERSTATS_HPP
@@ -0,0 +1,349 @@
+// WordLog.cpp
+//
+// ICS 46 Spring 2018
+// Project #4: Set the Controls for the Heart of the Sun
+
+#include "WordLog.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+
+namespace
+{
+    // A snapshot begins with this header, followed by its records.
+    struct SnapshotHeader
+    {
+        char magic[4];
+        std::uint32_t version;
+        std::uint64_t count;
+        std::uint64_t recordBytes;
+        std::uint32_t checksum;
+        std::uint32_t unused;
+    };
+
+    constexpr char SNAPSHOT_MAGIC[4] = {'W', 'S', 'N', 'P'};
+    constexpr std::uint32_t SNAPSHOT_VERSION = 1;
+
+    // Each record (in the log or the snapshot) begins with the word's
+    // length and a CRC-32 of the word.
+    constexpr std::size_t RECORD_HEADER_BYTES = 2 * sizeof(std::uint32_t);
+
+
+    // crc32() returns the CRC-32 (the one used by zip and PNG) of the given
+    // bytes, continuing from a previous result.
+    std::uint32_t crc32(const char* bytes, std::size_t length, std::uint32_t crc = 0) noexcept
+    {
+        struct Table
+        {
+            std::uint32_t entries[256];
+
+            Table() noexcept
+            {
+                for(std::uint32_t i = 0; i < 256; i++) {
+                    std::uint32_t entry = i;
+                    for(int bit = 0; bit < 8; bit++) {
+                        entry = (entry >> 1) ^ (0xEDB88320u & (0u - (entry & 1)));
+                    }
+                    entries[i] = entry;
+                }
+            }
+        };
+
+        static const Table table;
+
+        crc = ~crc;
+        for(std::size_t i = 0; i < length; i++) {
+            crc = table.entries[(crc ^ static_cast<unsigned char>(bytes[i])) & 0xFF] ^ (crc >> 8);
+        }
+        return ~crc;
+    }
+
+
+    [[noreturn]] void fail(const std::string& what)
+    {
+        throw std::system_error{errno, std::generic_category(), "WordLog: " + what};
+    }
+
+
+    // writeAll() writes all of the given bytes, however many calls to
+    // write() that takes.
+    void writeAll(int file, const char* bytes, std::size_t length, const std::string& path)
+    {
+        while(length > 0) {
+            ssize_t written = write(file, bytes, length);
+            if(written < 0) {
+                if(errno == EINTR) {
+                    continue;
+                }
+                fail("cannot write " + path);
+            }
+
+            bytes += written;
+            length -= static_cast<std::size_t>(written);
+        }
+    }
+
+
+    // readRecords() reads the records at the start of the given bytes into
+    // "words", stopping at the first one that's incomplete or damaged, and
+    // returns the number of bytes of good records.
+    std::size_t readRecords(const char* bytes, std::size_t length, std::vector<std::string>& words)
+    {
+        std::size_t position = 0;
+
+        while(length - position >= RECORD_HEADER_BYTES) {
+            std::uint32_t wordLength;
+            std::uint32_t checksum;
+            std::memcpy(&wordLength, bytes + position, sizeof(wordLength));
+            std::memcpy(&checksum, bytes + position + sizeof(wordLength), sizeof(checksum));
+
+            const char* word = bytes + position + RECORD_HEADER_BYTES;
+            if(wordLength > length - position - RECORD_HEADER_BYTES || crc32(word, wordLength) != checksum) {
+                break;
+            }
+
+            words.emplace_back(word, wordLength);
+            position += RECORD_HEADER_BYTES + wordLength;
+        }
+
+        return position;
+    }
+
+
+    bool fileExists(const std::string& path)
+    {
+        struct stat status;
+        return stat(path.c_str(), &status) == 0;
+    }
+
+
+    std::string readFile(const std::string& path)
+    {
+        std::ifstream file{path, std::ios::binary};
+        return std::string{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+    }
+
+
+    // directoryOf() returns the directory that the file at the given path
+    // is in, whose entry for the file has to be synced after a rename.
+    std::string directoryOf(const std::string& path)
+    {
+        std::string::size_type slash = path.rfind('/');
+        if(slash == std::string::npos) {
+            return ".";
+        }
+        return slash == 0 ? "/" : path.substr(0, slash);
+    }
+}
+
+
+
+WordLog::WordLog(const std::string& path)
+    : WordLog{path, Options{}}
+{
+}
+
+
+WordLog::WordLog(const std::string& path, Options options)
+    : logPath{path + ".log"}, snapshotPath{path + ".snapshot"}, sync{options.sync}, logFile{-1},
+      appended{0}, durable{0}, flushing{false}, broken{false}, _logBytes{0}
+{
+    logFile = open(logPath.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if(logFile < 0) {
+        fail("cannot open " + logPath);
+    }
+
+    struct stat status;
+    if(fstat(logFile, &status) == 0) {
+        _logBytes = static_cast<std::size_t>(status.st_size);
+    }
+}
+
+
+WordLog::~WordLog() noexcept
+{
+    close(logFile);
+}
+
+
+bool WordLog::snapshotExists(const std::string& path)
+{
+    return fileExists(path + ".snapshot");
+}
+
+
+void WordLog::recover(std::vector<std::string>& snapshot, std::vector<std::string>& tail)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+
+    snapshot.clear();
+    tail.clear();
+
+    if(fileExists(snapshotPath)) {
+        std::string contents = readFile(snapshotPath);
+
+        SnapshotHeader header;
+        if(contents.size() < sizeof(header)) {
+            throw std::runtime_error{"WordLog: " + snapshotPath + " is damaged"};
+        }
+        std::memcpy(&header, contents.data(), sizeof(header));
+
+        const char* records = contents.data() + sizeof(header);
+        std::size_t recordBytes = contents.size() - sizeof(header);
+
+        if(std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0
+           || header.version != SNAPSHOT_VERSION
+           || header.recordBytes != recordBytes
+           || crc32(records, recordBytes) != header.checksum) {
+            throw std::runtime_error{"WordLog: " + snapshotPath + " is damaged"};
+        }
+
+        snapshot.reserve(header.count);
+        if(readRecords(records, recordBytes, snapshot) != recordBytes || snapshot.size() != header.count) {
+            throw std::runtime_error{"WordLog: " + snapshotPath + " is damaged"};
+        }
+    }
+
+    std::string contents = readFile(logPath);
+    std::size_t good = readRecords(contents.data(), contents.size(), tail);
+
+    // whatever follows the last good record was being written when the
+    // program stopped, and new records have to follow the good ones
+    if(good < contents.size()) {
+        if(ftruncate(logFile, static_cast<off_t>(good)) != 0) {
+            fail("cannot truncate " + logPath);
+        }
+    }
+    _logBytes = good;
+}
+
+
+void WordLog::append(const std::string& word)
+{
+    std::unique_lock<std::mutex> lock{mutex};
+    if(broken) {
+        throw std::system_error{EIO, std::generic_category(), "WordLog: an earlier write to " + logPath + " failed"};
+    }
+
+    appendRecord(pending, word);
+    std::uint64_t ticket = ++appended;
+
+    while(durable < ticket) {
+        if(broken) {
+            throw std::system_error{EIO, std::generic_category(), "WordLog: an earlier write to " + logPath + " failed"};
+        }
+
+        if(flushing) {
+            flushed.wait(lock);
+            continue;
+        }
+
+        // become the leader: write everything pending so far, including the
+        // records of any threads waiting on this one
+        flushing = true;
+        std::string batch;
+        batch.swap(pending);
+        std::uint64_t last = appended;
+        lock.unlock();
+
+        try {
+            writeAll(logFile, batch.data(), batch.size(), logPath);
+            if(sync && fdatasync(logFile) != 0) {
+                fail("cannot sync " + logPath);
+            }
+        }
+        catch(...) {
+            lock.lock();
+            flushing = false;
+            broken = true;
+            flushed.notify_all();
+            throw;
+        }
+
+        lock.lock();
+        flushing = false;
+        durable = last;
+        _logBytes += batch.size();
+        flushed.notify_all();
+    }
+}
+
+
+std::size_t WordLog::logBytes() const
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    return _logBytes;
+}
+
+
+void WordLog::appendRecord(std::string& records, const std::string& word)
+{
+    std::uint32_t length = static_cast<std::uint32_t>(word.size());
+    std::uint32_t checksum = crc32(word.data(), word.size());
+
+    records.append(reinterpret_cast<const char*>(&length), sizeof(length));
+    records.append(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+    records.append(word);
+}
+
+
+void WordLog::writeSnapshot(const std::string& records, std::uint64_t count)
+{
+    std::unique_lock<std::mutex> lock{mutex};
+    flushed.wait(lock, [&] { return !flushing; });
+
+    SnapshotHeader header{};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.version = SNAPSHOT_VERSION;
+    header.count = count;
+    header.recordBytes = records.size();
+    header.checksum = crc32(records.data(), records.size());
+
+    std::string temporaryPath = snapshotPath + ".tmp";
+    int file = open(temporaryPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if(file < 0) {
+        fail("cannot create " + temporaryPath);
+    }
+
+    try {
+        writeAll(file, reinterpret_cast<const char*>(&header), sizeof(header), temporaryPath);
+        writeAll(file, records.data(), records.size(), temporaryPath);
+        if(sync && fsync(file) != 0) {
+            fail("cannot sync " + temporaryPath);
+        }
+    }
+    catch(...) {
+        close(file);
+        unlink(temporaryPath.c_str());
+        throw;
+    }
+    close(file);
+
+    if(rename(temporaryPath.c_str(), snapshotPath.c_str()) != 0) {
+        fail("cannot rename " + temporaryPath);
+    }
+
+    if(sync) {
+        int directory = open(directoryOf(snapshotPath).c_str(), O_RDONLY | O_CLOEXEC);
+        if(directory >= 0) {
+            fsync(directory);
+            close(directory);
+        }
+    }
+
+    // only now that the snapshot is safely in place can the log go
+    if(ftruncate(logFile, 0) != 0 || (sync && fdatasync(logFile) != 0)) {
+        fail("cannot truncate " + logPath);
+    }
+    _logBytes = 0;
+}
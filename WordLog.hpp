@@ -0,0 +1,141 @@
+// WordLog.hpp
+//
+// ICS 46 Spring 2018
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// A WordLog keeps the words added to a dictionary at run time on disk, in
+// two files next to each other: a snapshot of the whole dictionary as of
+// the last compaction ("<path>.snapshot") and an append-only log of the
+// words added since then ("<path>.log").  Restarting costs one bulk load
+// of the snapshot plus the (short) tail of the log, rather than replaying
+// every word ever added.
+//
+// Each log record is the word's length, a CRC-32 of the word, and the word
+// itself.  A crash can leave a partly written record at the end of the
+// log; recover() stops at the first record that's incomplete or fails its
+// check and cuts the log off there.  The snapshot has a header with its
+// own CRC-32 of everything after it; since it's written to a temporary file
+// and renamed into place, a damaged snapshot means something other than a
+// crash went wrong, so recover() throws rather than dropping words.
+//
+// append() uses group commit: threads that append at the same time have
+// their records written with a single write() and made durable with a
+// single fdatasync(), which one of them (the "leader") does on behalf of
+// the others while they wait.  Each append() returns only once its record
+// is durable.
+//
+// compact() writes a new snapshot and then empties the log.  If it's
+// interrupted after the rename but before the log is emptied, the words in
+// the log are also in the snapshot, and replaying them again is harmless.
+//
+// You are permitted to use the C++ Standard Library in this class.
+
+#ifndef WORDLOG_HPP
+#define WORDLOG_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+
+class WordLog
+{
+public:
+    struct Options
+    {
+        // whether append() and compact() wait for the data to reach the
+        // disk; turning this off is only sensible for testing
+        bool sync = true;
+    };
+
+public:
+    // Opens (creating, if necessary) the log whose files are named after
+    // the given path.  It throws a std::system_error if the log can't be
+    // opened.
+    explicit WordLog(const std::string& path);
+    WordLog(const std::string& path, Options options);
+
+    ~WordLog() noexcept;
+
+    WordLog(const WordLog& l) = delete;
+    WordLog& operator=(const WordLog& l) = delete;
+
+
+    // snapshotExists() returns true if a snapshot has been written for the
+    // given path, i.e., if the dictionary has been saved at least once.
+    static bool snapshotExists(const std::string& path);
+
+
+    // recover() sets "snapshot" to the words in the snapshot (none, if there
+    // isn't one yet) and "tail" to the words in the log, in the order they
+    // were appended, cutting off a partly written record at the end of the
+    // log.  It throws a std::runtime_error if the snapshot is damaged.
+    void recover(std::vector<std::string>& snapshot, std::vector<std::string>& tail);
+
+
+    // append() adds a word to the log, returning once it's durable.  It
+    // throws a std::system_error if the word can't be written; after that,
+    // the log can't be appended to any more.
+    void append(const std::string& word);
+
+
+    // compact() replaces the snapshot with one holding every element of an
+    // ordered set (such as an AVLSet), visited with its inorder() function,
+    // and then empties the log.  No words may be appended while it runs.
+    template <typename OrderedSet>
+    void compact(const OrderedSet& words);
+
+
+    // logBytes() returns the size of the log, which compact() resets to 0.
+    std::size_t logBytes() const;
+
+
+private:
+    std::string logPath;
+    std::string snapshotPath;
+    bool sync;
+    int logFile;
+
+    mutable std::mutex mutex;
+    std::condition_variable flushed;
+
+    // records that have been appended but not yet written
+    std::string pending;
+
+    // how many records have been appended, and how many of those are known
+    // to be durable
+    std::uint64_t appended;
+    std::uint64_t durable;
+
+    bool flushing;
+    bool broken;
+    std::size_t _logBytes;
+
+    static void appendRecord(std::string& records, const std::string& word);
+
+    void writeSnapshot(const std::string& records, std::uint64_t count);
+};
+
+
+
+template <typename OrderedSet>
+void WordLog::compact(const OrderedSet& words)
+{
+    std::string records;
+    std::uint64_t count = 0;
+
+    words.inorder([&](const std::string& word) {
+        appendRecord(records, word);
+        count++;
+    });
+
+    writeSnapshot(records, count);
+}
+
+
+
+#endif // WORDLOG_HPP
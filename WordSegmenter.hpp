@@ -0,0 +1,209 @@
+// WordSegmenter.hpp
+//
+// ICS 46 Spring 2018
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// A WordSegmenter splits text that has several words run together (such as
+// "THEQUICKBROWNFOX") into dictionary words.  Where technique 5 of the
+// WordChecker only tries splitting a word in two, a WordSegmenter finds
+// segmentations into any number of words.
+//
+// It works over a prefix index, which is any type with a member function
+//
+//     template <typename Visit>
+//     void forEachWordAt(const std::string& text, std::string::size_type start, Visit visit) const;
+//
+// that calls visit(length) for each dictionary word that appears in the
+// text at the given position.  AutocompleteIndex is one.  A single forward
+// pass asks the index for the words starting at every position, which takes
+// O(n * m) time for text of length n and words of length up to m, since the
+// index walks along the text rather than looking up every substring.  A
+// backward pass then works out, for every position, the fewest words that
+// the rest of the text can be split into (or that it can't be split at
+// all).  The best segmentation follows from that directly, and listing all
+// of them never wanders into a position that leads nowhere.
+//
+// You are permitted to use the C++ Standard Library in this class.
+
+#ifndef WORDSEGMENTER_HPP
+#define WORDSEGMENTER_HPP
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+
+
+template <typename PrefixIndex>
+class WordSegmenter
+{
+public:
+    // The most segmentations that all() returns unless told otherwise.
+    static constexpr unsigned int DEFAULT_LIMIT = 100;
+
+public:
+    // Initializes a WordSegmenter that finds words using the given index,
+    // which must outlive it.
+    explicit WordSegmenter(const PrefixIndex& index);
+
+
+    // best() returns a segmentation of the text into the fewest possible
+    // words, preferring longer words earlier when there's a tie, or an
+    // empty vector if the text can't be segmented.
+    std::vector<std::string> best(const std::string& text) const;
+
+
+    // all() returns up to "limit" segmentations of the text, those with
+    // longer first words (and then longer second words, and so on) first.
+    // Text that can't be segmented has none.
+    std::vector<std::vector<std::string>> all(const std::string& text, unsigned int limit = DEFAULT_LIMIT) const;
+
+
+private:
+    static constexpr unsigned int UNREACHABLE = static_cast<unsigned int>(-1);
+
+    const PrefixIndex& index;
+
+    // The words found in one text, and the fewest words that the text can
+    // be split into from each position.  The lengths of the words starting
+    // at position i are lengths[starts[i]] through lengths[starts[i + 1] - 1],
+    // longest first.
+    struct Lattice
+    {
+        std::vector<std::string::size_type> starts;
+        std::vector<std::string::size_type> lengths;
+        std::vector<unsigned int> fewest;
+    };
+
+    Lattice buildLattice(const std::string& text) const;
+
+    void collect(
+        const std::string& text, const Lattice& lattice, std::string::size_type position,
+        std::vector<std::string>& current, std::vector<std::vector<std::string>>& result,
+        unsigned int limit) const;
+};
+
+
+
+template <typename PrefixIndex>
+WordSegmenter<PrefixIndex>::WordSegmenter(const PrefixIndex& index)
+    : index{index}
+{
+}
+
+
+template <typename PrefixIndex>
+std::vector<std::string> WordSegmenter<PrefixIndex>::best(const std::string& text) const
+{
+    Lattice lattice = buildLattice(text);
+
+    std::vector<std::string> result;
+    if(text.empty() || lattice.fewest[0] == UNREACHABLE) {
+        return result;
+    }
+
+    result.reserve(lattice.fewest[0]);
+
+    std::string::size_type position = 0;
+    while(position < text.size()) {
+        // the first word that leads to a segmentation as short as the best
+        // one is also the longest such word
+        for(std::string::size_type w = lattice.starts[position]; w < lattice.starts[position + 1]; w++) {
+            std::string::size_type length = lattice.lengths[w];
+            if(lattice.fewest[position + length] + 1 == lattice.fewest[position]) {
+                result.push_back(text.substr(position, length));
+                position += length;
+                break;
+            }
+        }
+    }
+
+    return result;
+}
+
+
+template <typename PrefixIndex>
+std::vector<std::vector<std::string>> WordSegmenter<PrefixIndex>::all(const std::string& text, unsigned int limit) const
+{
+    std::vector<std::vector<std::string>> result;
+    if(text.empty() || limit == 0) {
+        return result;
+    }
+
+    Lattice lattice = buildLattice(text);
+    if(lattice.fewest[0] == UNREACHABLE) {
+        return result;
+    }
+
+    std::vector<std::string> current;
+    collect(text, lattice, 0, current, result, limit);
+    return result;
+}
+
+
+template <typename PrefixIndex>
+typename WordSegmenter<PrefixIndex>::Lattice WordSegmenter<PrefixIndex>::buildLattice(const std::string& text) const
+{
+    std::string::size_type n = text.size();
+
+    Lattice lattice;
+    lattice.starts.reserve(n + 1);
+
+    for(std::string::size_type position = 0; position < n; position++) {
+        std::string::size_type first = lattice.lengths.size();
+        lattice.starts.push_back(first);
+
+        index.forEachWordAt(text, position,
+            [&](std::string::size_type length) { lattice.lengths.push_back(length); });
+
+        // the index reports the shortest word first
+        std::reverse(lattice.lengths.begin() + first, lattice.lengths.end());
+    }
+    lattice.starts.push_back(lattice.lengths.size());
+
+    lattice.fewest.assign(n + 1, UNREACHABLE);
+    lattice.fewest[n] = 0;
+
+    for(std::string::size_type position = n; position-- > 0; ) {
+        for(std::string::size_type w = lattice.starts[position]; w < lattice.starts[position + 1]; w++) {
+            unsigned int rest = lattice.fewest[position + lattice.lengths[w]];
+            if(rest != UNREACHABLE && rest + 1 < lattice.fewest[position]) {
+                lattice.fewest[position] = rest + 1;
+            }
+        }
+    }
+
+    return lattice;
+}
+
+
+template <typename PrefixIndex>
+void WordSegmenter<PrefixIndex>::collect(
+    const std::string& text, const Lattice& lattice, std::string::size_type position,
+    std::vector<std::string>& current, std::vector<std::vector<std::string>>& result,
+    unsigned int limit) const
+{
+    if(position == text.size()) {
+        result.push_back(current);
+        return;
+    }
+
+    for(std::string::size_type w = lattice.starts[position]; w < lattice.starts[position + 1]; w++) {
+        if(result.size() >= limit) {
+            return;
+        }
+
+        std::string::size_type length = lattice.lengths[w];
+        if(lattice.fewest[position + length] == UNREACHABLE) {
+            continue;
+        }
+
+        current.push_back(text.substr(position, length));
+        collect(text, lattice, position + length, current, result, limit);
+        current.pop_back();
+    }
+}
+
+
+
+#endif // WORDSEGMENTER_HPP